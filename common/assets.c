@@ -0,0 +1,136 @@
+#include "assets.h"
+#include "pak.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// One entry of the open archive; the Sound exists while it's acquired
+typedef struct {
+    const PakEntry *entry;
+    Sound *sound;
+    int refs;
+} Asset;
+
+static const Uint8 *archive;
+static size_t archive_size;
+static Asset *assets;
+static int asset_count;
+
+// Whole file, read-only and shared with every other process using it
+static const Uint8 *map_file(const char *path, size_t *size) {
+#ifndef _WIN32
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    void *data = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd); // The mapping keeps the file
+    if (data == MAP_FAILED) return NULL;
+    *size = (size_t)st.st_size;
+    return data;
+#else
+    // No mmap here; a plain read keeps the rest of the loader the same
+    SDL_RWops *rw = SDL_RWFromFile(path, "rb");
+    if (!rw) return NULL;
+    Sint64 length = SDL_RWsize(rw);
+    Uint8 *data = length > 0 ? malloc((size_t)length) : NULL;
+    if (data && SDL_RWread(rw, data, 1, (size_t)length) != (size_t)length) {
+        free(data);
+        data = NULL;
+    }
+    SDL_RWclose(rw);
+    *size = (size_t)length;
+    return data;
+#endif
+}
+
+static void unmap_file(const Uint8 *data, size_t size) {
+#ifndef _WIN32
+    munmap((void *)data, size);
+#else
+    free((void *)data);
+#endif
+}
+
+int assets_open(const char *name) {
+    char path[1024];
+    char *base = SDL_GetBasePath();
+    snprintf(path, sizeof(path), "%s%s", base ? base : "", name);
+    SDL_free(base);
+
+    archive = map_file(path, &archive_size);
+    if (!archive) {
+        printf("Can't open asset archive %s\n", path);
+        return 0;
+    }
+
+    // Check everything up front so lookups can trust the table
+    const PakHeader *header = (const PakHeader *)archive;
+    int valid = archive_size >= sizeof(PakHeader) && memcmp(header->magic, PAK_MAGIC, 4) == 0 &&
+                header->version == PAK_VERSION &&
+                header->count <= (archive_size - sizeof(PakHeader)) / sizeof(PakEntry);
+    const PakEntry *entries = (const PakEntry *)(header + 1);
+    for (Uint32 i = 0; valid && i < header->count; i++) {
+        const PakEntry *e = &entries[i];
+        valid = memchr(e->name, 0, PAK_NAME_LEN) && e->offset % PAK_ALIGN == 0 &&
+                e->offset <= archive_size && e->size <= archive_size - e->offset &&
+                e->size % (2 * sizeof(float)) == 0;
+    }
+    assets = valid ? calloc(header->count ? header->count : 1, sizeof(Asset)) : NULL;
+    if (!assets) {
+        printf(valid ? "Out of memory opening %s\n" : "Asset archive %s is damaged or out of date\n", path);
+        unmap_file(archive, archive_size);
+        archive = NULL;
+        return 0;
+    }
+    asset_count = (int)header->count;
+    for (int i = 0; i < asset_count; i++) assets[i].entry = &entries[i];
+    return 1;
+}
+
+void assets_close(void) {
+    if (!archive) return;
+    for (int i = 0; i < asset_count; i++) audio_free(assets[i].sound);
+    free(assets);
+    assets = NULL;
+    asset_count = 0;
+    unmap_file(archive, archive_size);
+    archive = NULL;
+}
+
+Sound *assets_acquire_sound(const char *name) {
+    for (int i = 0; i < asset_count; i++) {
+        Asset *a = &assets[i];
+        if (strcmp(a->entry->name, name) != 0) continue;
+        if (!a->sound) {
+            const float *samples = (const float *)(archive + a->entry->offset);
+            a->sound = audio_create_sound(samples, (int)(a->entry->size / (2 * sizeof(float))));
+            if (!a->sound) return NULL;
+        }
+        a->refs++;
+        return a->sound;
+    }
+    printf("Sound %s is not in the asset archive\n", name);
+    return NULL;
+}
+
+void assets_release_sound(Sound *sound) {
+    for (int i = 0; sound && i < asset_count; i++) {
+        Asset *a = &assets[i];
+        if (a->sound != sound) continue;
+        if (--a->refs == 0) {
+            audio_free(a->sound);
+            a->sound = NULL;
+        }
+        return;
+    }
+}
\ No newline at end of file
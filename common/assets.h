@@ -0,0 +1,18 @@
+#ifndef ASSETS_H
+#define ASSETS_H
+
+#include <SDL2/SDL.h>
+#include "audio.h"
+
+// Map the archive `name` from the executable's directory (the build puts it
+// there), so the game runs from any working directory
+int assets_open(const char *name);
+// Unmap the archive; stop audio and release every sound first
+void assets_close(void);
+
+// Sound played straight from the mapped archive. Every acquire of a name
+// returns the same Sound; NULL if the archive has no such entry
+Sound *assets_acquire_sound(const char *name);
+void assets_release_sound(Sound *sound);
+
+#endif // ASSETS_H
\ No newline at end of file
@@ -0,0 +1,288 @@
+#include "audio.h"
+#include <stdlib.h>
+#include <limits.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define AUDIO_X86 1
+#endif
+
+// Interleaved stereo samples in [-1, 1]
+struct Sound {
+    const float *samples;
+    int frames;
+};
+
+typedef enum {
+    AUDIO_PLAY,
+    AUDIO_STOP
+} AudioCommandType;
+
+typedef struct {
+    AudioCommandType type;
+    AudioVoice voice;
+    const Sound *sound;
+    AudioPriority priority;
+    int loop;
+} AudioCommand;
+
+typedef struct {
+    const Sound *sound; // NULL when free
+    AudioVoice id;
+    AudioPriority priority;
+    int loop;
+    int position;       // Next frame to mix
+    Uint32 started;     // Callback count at start; the oldest loses ties when stealing
+} Voice;
+
+// Command ring: the game thread writes queue_head, the audio callback writes
+// queue_tail, and neither ever blocks
+static AudioCommand queue[AUDIO_QUEUE_SIZE];
+static SDL_atomic_t queue_head, queue_tail;
+static AudioVoice next_voice = 1;
+
+// Owned by the audio callback
+static Voice voices[AUDIO_VOICES];
+static float mix[AUDIO_BUFFER_FRAMES * 2];
+static Uint32 callbacks;
+
+static SDL_AudioDeviceID device;
+
+// dst[i] += src[i]
+typedef void (*MixFn)(float *dst, const float *src, int count);
+// Clamp and convert to 16-bit
+typedef void (*OutputFn)(Sint16 *dst, const float *src, int count);
+static MixFn mix_samples;
+static OutputFn output_samples;
+
+static void mix_samples_scalar(float *dst, const float *src, int count) {
+    for (int i = 0; i < count; i++) dst[i] += src[i];
+}
+
+static void output_samples_scalar(Sint16 *dst, const float *src, int count) {
+    for (int i = 0; i < count; i++) {
+        float v = src[i] * 32768.0f;
+        if (v > 32767.0f) v = 32767.0f;
+        if (v < -32768.0f) v = -32768.0f;
+        dst[i] = (Sint16)(v + (v >= 0 ? 0.5f : -0.5f));
+    }
+}
+
+#ifdef AUDIO_X86
+__attribute__((target("sse2")))
+static void mix_samples_sse2(float *dst, const float *src, int count) {
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_loadu_ps(src + i)));
+    }
+    mix_samples_scalar(dst + i, src + i, count - i);
+}
+
+__attribute__((target("avx2")))
+static void mix_samples_avx2(float *dst, const float *src, int count) {
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_loadu_ps(src + i)));
+    }
+    mix_samples_scalar(dst + i, src + i, count - i);
+}
+
+__attribute__((target("sse2")))
+static void output_samples_sse2(Sint16 *dst, const float *src, int count) {
+    const __m128 scale = _mm_set1_ps(32768.0f);
+    const __m128 lo = _mm_set1_ps(-32768.0f), hi = _mm_set1_ps(32767.0f);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        // Clamp before converting: out-of-range floats convert to INT_MIN
+        __m128 a = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i), scale), lo), hi);
+        __m128 b = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i + 4), scale), lo), hi);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+    }
+    output_samples_scalar(dst + i, src + i, count - i);
+}
+#endif
+
+static void pick_mixers(void) {
+    mix_samples = mix_samples_scalar;
+    output_samples = output_samples_scalar;
+#ifdef AUDIO_X86
+    if (SDL_HasSSE2()) {
+        mix_samples = mix_samples_sse2;
+        output_samples = output_samples_sse2;
+    }
+    if (SDL_HasAVX2()) mix_samples = mix_samples_avx2;
+#endif
+}
+
+// Free voice, or the one to steal; NULL if every voice outranks the new sound
+static Voice *pick_voice(AudioPriority priority) {
+    Voice *victim = NULL;
+    for (int i = 0; i < AUDIO_VOICES; i++) {
+        Voice *v = &voices[i];
+        if (!v->sound) return v;
+        if (v->priority > priority) continue;
+        if (!victim || v->priority < victim->priority ||
+            (v->priority == victim->priority && (Sint32)(v->started - victim->started) < 0)) {
+            victim = v;
+        }
+    }
+    return victim;
+}
+
+static void run_command(const AudioCommand *cmd) {
+    if (cmd->type == AUDIO_PLAY) {
+        Voice *v = pick_voice(cmd->priority);
+        if (!v) return; // Dropped: everything playing matters more
+        v->sound = cmd->sound;
+        v->id = cmd->voice;
+        v->priority = cmd->priority;
+        v->loop = cmd->loop;
+        v->position = 0;
+        v->started = callbacks;
+    } else {
+        for (int i = 0; i < AUDIO_VOICES; i++) {
+            if (voices[i].sound && voices[i].id == cmd->voice) voices[i].sound = NULL;
+        }
+    }
+}
+
+// Add `frames` frames of a voice to the mix, looping or freeing it at the end
+static void mix_voice(Voice *v, int frames) {
+    int done = 0;
+    while (done < frames && v->sound) {
+        int n = v->sound->frames - v->position;
+        if (n > frames - done) n = frames - done;
+        mix_samples(mix + done * 2, v->sound->samples + v->position * 2, n * 2);
+        done += n;
+        v->position += n;
+        if (v->position == v->sound->frames) {
+            v->position = 0;
+            if (!v->loop) v->sound = NULL;
+        }
+    }
+}
+
+static void SDLCALL audio_callback(void *userdata, Uint8 *stream, int len) {
+    // Pick up everything queued since the last callback
+    Uint32 tail = (Uint32)SDL_AtomicGet(&queue_tail);
+    Uint32 head = (Uint32)SDL_AtomicGet(&queue_head);
+    SDL_MemoryBarrierAcquire();
+    for (; tail != head; tail++) run_command(&queue[tail & (AUDIO_QUEUE_SIZE - 1)]);
+    SDL_AtomicSet(&queue_tail, (int)tail);
+
+    // The device may ask for more than one buffer; mix in buffer-sized blocks
+    Sint16 *out = (Sint16 *)stream;
+    int frames = len / (int)(2 * sizeof(Sint16));
+    while (frames > 0) {
+        int n = frames < AUDIO_BUFFER_FRAMES ? frames : AUDIO_BUFFER_FRAMES;
+        SDL_memset(mix, 0, n * 2 * sizeof(float));
+        for (int i = 0; i < AUDIO_VOICES; i++) {
+            if (voices[i].sound) mix_voice(&voices[i], n);
+        }
+        output_samples(out, mix, n * 2);
+        out += n * 2;
+        frames -= n;
+    }
+    callbacks++;
+}
+
+static int push_command(const AudioCommand *cmd) {
+    Uint32 head = (Uint32)SDL_AtomicGet(&queue_head);
+    Uint32 tail = (Uint32)SDL_AtomicGet(&queue_tail);
+    if (head - tail == AUDIO_QUEUE_SIZE) return 0;
+    queue[head & (AUDIO_QUEUE_SIZE - 1)] = *cmd;
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&queue_head, (int)(head + 1));
+    return 1;
+}
+
+int audio_init(void) {
+    pick_mixers();
+    SDL_memset(voices, 0, sizeof(voices));
+    SDL_AtomicSet(&queue_head, 0);
+    SDL_AtomicSet(&queue_tail, 0);
+
+    SDL_AudioSpec want;
+    SDL_memset(&want, 0, sizeof(want));
+    want.freq = AUDIO_FREQ;
+    want.format = AUDIO_S16SYS;
+    want.channels = 2;
+    want.samples = AUDIO_BUFFER_FRAMES;
+    want.callback = audio_callback;
+    // No allowed changes: SDL converts if the hardware wants something else
+    device = SDL_OpenAudioDevice(NULL, 0, &want, NULL, 0);
+    if (!device) return 0;
+    SDL_PauseAudioDevice(device, 0);
+    return 1;
+}
+
+void audio_shutdown(void) {
+    if (!device) return;
+    SDL_CloseAudioDevice(device);
+    device = 0;
+}
+
+float *audio_decode_wav(const char *path, int *frames) {
+    SDL_AudioSpec spec;
+    Uint8 *data;
+    Uint32 length;
+    if (!SDL_LoadWAV(path, &spec, &data, &length)) return NULL;
+
+    // Convert to the output format once, so mixing is a plain add
+    SDL_AudioCVT cvt;
+    if (SDL_BuildAudioCVT(&cvt, spec.format, spec.channels, spec.freq, AUDIO_S16SYS, 2, AUDIO_FREQ) < 0) {
+        SDL_FreeWAV(data);
+        return NULL;
+    }
+    cvt.len = (int)length;
+    cvt.buf = SDL_malloc((size_t)length * cvt.len_mult);
+    if (!cvt.buf) {
+        SDL_FreeWAV(data);
+        SDL_SetError("Out of memory converting %s", path);
+        return NULL;
+    }
+    SDL_memcpy(cvt.buf, data, length);
+    SDL_FreeWAV(data);
+    if (SDL_ConvertAudio(&cvt) < 0) {
+        SDL_free(cvt.buf);
+        return NULL;
+    }
+
+    *frames = cvt.len_cvt / (int)(2 * sizeof(Sint16));
+    float *samples = malloc((size_t)(*frames > 0 ? *frames : 1) * 2 * sizeof(float));
+    if (!samples) {
+        SDL_free(cvt.buf);
+        SDL_SetError("Out of memory loading %s", path);
+        return NULL;
+    }
+    const Sint16 *pcm = (const Sint16 *)cvt.buf;
+    for (int i = 0; i < *frames * 2; i++) samples[i] = pcm[i] / 32768.0f;
+    SDL_free(cvt.buf);
+    return samples;
+}
+
+Sound *audio_create_sound(const float *samples, int frames) {
+    Sound *sound = malloc(sizeof(Sound));
+    if (!sound) return NULL;
+    sound->samples = samples;
+    sound->frames = frames;
+    return sound;
+}
+
+void audio_free(Sound *sound) {
+    free(sound);
+}
+
+AudioVoice audio_play(const Sound *sound, AudioPriority priority, int loop) {
+    if (!sound || sound->frames == 0) return 0;
+    AudioCommand cmd = {AUDIO_PLAY, next_voice, sound, priority, loop};
+    if (!push_command(&cmd)) return 0;
+    next_voice = next_voice == INT_MAX ? 1 : next_voice + 1;
+    return cmd.voice;
+}
+
+void audio_stop(AudioVoice voice) {
+    if (!voice) return;
+    AudioCommand cmd = {AUDIO_STOP, voice, NULL, AUDIO_PRIORITY_LOW, 0};
+    push_command(&cmd);
+}
\ No newline at end of file
@@ -0,0 +1,49 @@
+#ifndef AUDIO_H
+#define AUDIO_H
+
+#include <SDL2/SDL.h>
+
+// Output format: 16-bit stereo at 44.1 kHz
+#define AUDIO_FREQ 44100
+// Frames per device callback (about 5.8 ms)
+#define AUDIO_BUFFER_FRAMES 256
+// Sounds that can play at once; past this a new sound steals a voice
+#define AUDIO_VOICES 8
+// Pending play/stop commands (power of two)
+#define AUDIO_QUEUE_SIZE 256
+
+// Samples in the mixer's format, played without copying
+typedef struct Sound Sound;
+
+// Identifies a playing sound; 0 is never a valid voice
+typedef int AudioVoice;
+
+// When all voices are busy a new sound takes the oldest voice of the lowest
+// priority, as long as that priority is no higher than its own
+typedef enum {
+    AUDIO_PRIORITY_LOW,
+    AUDIO_PRIORITY_NORMAL,
+    AUDIO_PRIORITY_HIGH
+} AudioPriority;
+
+// Open the audio device and start mixing (SDL audio must be initialized)
+int audio_init(void);
+// Stop mixing and close the device; call before freeing sounds
+void audio_shutdown(void);
+
+// Decode a WAV file into the mixer's format (interleaved float stereo at
+// AUDIO_FREQ); NULL on failure (see SDL_GetError). Free with free()
+float *audio_decode_wav(const char *path, int *frames);
+// Play `samples` in place; they must outlive the sound
+Sound *audio_create_sound(const float *samples, int frames);
+// Frees the sound only, never its samples
+void audio_free(Sound *sound);
+
+// Commands go through a single-producer queue: call these from one thread.
+// Queue a sound to start on the next callback (loop repeats it until
+// stopped). Returns 0 if the command queue is full
+AudioVoice audio_play(const Sound *sound, AudioPriority priority, int loop);
+// Queue a stop; voices that already finished or were stolen are ignored
+void audio_stop(AudioVoice voice);
+
+#endif // AUDIO_H
\ No newline at end of file
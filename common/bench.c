@@ -0,0 +1,157 @@
+#include "bench.h"
+#include "frame.h"
+#include "input.h"
+#include "raster.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static BenchOptions options;
+static const ScriptedKey *script;
+static int script_len;
+static Uint8 scripted_keys[SDL_NUM_SCANCODES];
+
+// Frame timings, preallocated for the whole run
+static float *frame_ms;
+static int frames_done;
+static Uint64 frame_start;
+static Uint64 run_start;
+
+int bench_parse_args(int argc, char *argv[], BenchOptions *opts) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--headless") == 0) {
+            opts->headless = 1;
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            opts->frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            opts->seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            opts->record_path = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            opts->replay_path = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            opts->threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--pipeline") == 0) {
+            opts->pipelined = 1;
+        } else {
+            printf("Usage: %s [--headless] [--frames N] [--seed S] [--record FILE] [--replay FILE] [--threads N] [--pipeline]\n", argv[0]);
+            return 0;
+        }
+    }
+    if (opts->headless && opts->frames <= 0) {
+        printf("--headless needs --frames N with N > 0\n");
+        return 0;
+    }
+    return 1;
+}
+
+int bench_init(const BenchOptions *opts, const ScriptedKey *keys, int keys_len) {
+    options = *opts;
+    script = keys;
+    script_len = keys_len;
+
+    // Every scripted key is an input the game reads
+    SDL_Scancode input_keys[INPUT_MAX_KEYS];
+    int input_key_count = 0;
+    for (int i = 0; i < keys_len && input_key_count < INPUT_MAX_KEYS; i++) {
+        int seen = 0;
+        for (int j = 0; j < input_key_count; j++) seen |= input_keys[j] == keys[i].key;
+        if (!seen) input_keys[input_key_count++] = keys[i].key;
+    }
+    if (!raster_init(options.threads ? options.threads : 1)) return 0;
+    if (!input_init(input_keys, input_key_count, options.record_path, options.replay_path, &options.seed)) {
+        return 0;
+    }
+    if (!options.headless) return 1;
+
+    SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+    SDL_SetHint(SDL_HINT_AUDIODRIVER, "dummy");
+    frame_ms = malloc(options.frames * sizeof(float));
+    if (!frame_ms) {
+        printf("Frame timing allocation failed\n");
+        return 0;
+    }
+    frames_done = 0;
+    return 1;
+}
+
+void bench_shutdown(void) {
+    raster_shutdown();
+    input_shutdown();
+    free(frame_ms);
+    frame_ms = NULL;
+}
+
+int bench_is_headless(void) {
+    return options.headless;
+}
+
+int bench_is_pipelined(void) {
+    return options.pipelined;
+}
+
+unsigned int bench_seed(void) {
+    return options.seed;
+}
+
+Uint32 bench_renderer_flags(void) {
+    return options.headless ? SDL_RENDERER_SOFTWARE : SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC;
+}
+
+void bench_frame_begin(void) {
+    frame_start = SDL_GetPerformanceCounter();
+    if (!options.headless) return;
+    if (frames_done == 0) run_start = frame_start;
+
+    for (int i = 0; i < script_len; i++) {
+        const ScriptedKey *k = &script[i];
+        Uint8 down = (frames_done + k->phase) % k->period < k->duty;
+        if (down == scripted_keys[k->key]) continue;
+        scripted_keys[k->key] = down;
+
+        // Event-driven games see the same presses as polling ones
+        SDL_Event event;
+        memset(&event, 0, sizeof(event));
+        event.type = down ? SDL_KEYDOWN : SDL_KEYUP;
+        event.key.state = down ? SDL_PRESSED : SDL_RELEASED;
+        event.key.keysym.scancode = k->key;
+        event.key.keysym.sym = SDL_GetKeyFromScancode(k->key);
+        SDL_PushEvent(&event);
+    }
+}
+
+int bench_frame_end(void) {
+    if (input_replay_done()) return 0;
+    if (!options.headless) return 1;
+    Uint64 now = SDL_GetPerformanceCounter();
+    frame_ms[frames_done++] = (float)((now - frame_start) * 1000.0 / SDL_GetPerformanceFrequency());
+    return frames_done < options.frames;
+}
+
+const Uint8 *bench_keyboard_state(void) {
+    return options.headless ? scripted_keys : SDL_GetKeyboardState(NULL);
+}
+
+void bench_delay(Uint32 ms) {
+    if (!options.headless) SDL_Delay(ms);
+}
+
+static int compare_float(const void *a, const void *b) {
+    float fa = *(const float *)a, fb = *(const float *)b;
+    return (fa > fb) - (fa < fb);
+}
+
+void bench_report(const char *name) {
+    if (!options.headless || frames_done == 0) return;
+    double seconds = (SDL_GetPerformanceCounter() - run_start) / (double)SDL_GetPerformanceFrequency();
+
+    qsort(frame_ms, frames_done, sizeof(float), compare_float);
+    float p50 = frame_ms[(frames_done - 1) * 50 / 100];
+    float p99 = frame_ms[(frames_done - 1) * 99 / 100];
+    float max = frame_ms[frames_done - 1];
+
+    printf("{\"game\": \"%s\", \"frames\": %d, \"seed\": %u, \"threads\": %d, \"pipelined\": %d, \"seconds\": %.3f, \"fps\": %.1f, "
+           "\"frame_ms\": {\"p50\": %.3f, \"p99\": %.3f, \"max\": %.3f}, \"frame_hash\": \"%08x\"}\n",
+           name, frames_done, options.seed, raster_threads(), options.pipelined, seconds, frames_done / seconds, p50, p99, max,
+           frame_checksum());
+}
@@ -0,0 +1,56 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <SDL2/SDL.h>
+
+// Command line options: --headless --frames N --seed S --record FILE --replay FILE
+// --threads N --pipeline
+typedef struct {
+    int headless;            // Dummy drivers, no throttling, scripted input
+    int frames;              // Frames to run before exiting in headless mode
+    unsigned int seed;       // Seed for the game's Rng
+    const char *record_path; // Record every tick's input here
+    const char *replay_path; // Play input (and seed) back from here
+    int threads;             // Rasterizer threads (raster.h), 0 for one
+    int pipelined;           // Simulate the next frame while drawing this one (pipeline.h)
+} BenchOptions;
+
+// A key held for `duty` frames out of every `period`, starting at `phase`.
+// The script's keys are also the keys the game records and replays
+typedef struct {
+    SDL_Scancode key;
+    int period, duty, phase;
+} ScriptedKey;
+
+// Parse the flags into options (keeping the caller's defaults); returns 0 on a bad argument
+int bench_parse_args(int argc, char *argv[], BenchOptions *options);
+// Select dummy drivers, preallocate frame timings, start the rasterizer
+// threads and open any recording or replay; call before SDL_Init
+int bench_init(const BenchOptions *options, const ScriptedKey *script, int script_len);
+void bench_shutdown(void);
+
+int bench_is_headless(void);
+// Games that support it run pipelined frames (pipeline.h)
+int bench_is_pipelined(void);
+// Seed for the game's Rng (the recorded one when replaying)
+unsigned int bench_seed(void);
+// Renderer flags that work on the selected video driver (vsynced when windowed)
+Uint32 bench_renderer_flags(void);
+
+// Start timing a frame; in headless mode also advances the input script and
+// pushes SDL_KEYDOWN/SDL_KEYUP events for every scripted key that changed
+void bench_frame_begin(void);
+// Record the frame time; returns 0 once the headless frame budget is spent
+// or a replay has finished
+int bench_frame_end(void);
+// Live keyboard state: the real one, or the script in headless mode
+// (games read input_keys(), which latches this once per tick)
+const Uint8 *bench_keyboard_state(void);
+// SDL_Delay, skipped in headless mode
+void bench_delay(Uint32 ms);
+
+// Print fps, p50/p99/max frame time and the last frame's checksum as one
+// JSON line (headless mode only)
+void bench_report(const char *name);
+
+#endif // BENCH_H
@@ -0,0 +1,274 @@
+#include "blit.h"
+#include "raster.h"
+#include <limits.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BLIT_X86 1
+#endif
+
+// Row of 8 pixels drawn with vector stores; rows whose mask is zero are skipped
+typedef void (*BlitRowsFn)(Uint32 *dst, int pitch, const Uint8 *sprite, int height, Uint8 mask, Uint32 color);
+
+// Keep only the bits that fall inside the sprite width
+static Uint8 width_mask(int width) {
+    return (Uint8)(0xFF << (8 - width));
+}
+
+static void blit_rows_scalar(Uint32 *dst, int pitch, const Uint8 *sprite, int height, Uint8 mask, Uint32 color) {
+    for (int row = 0; row < height; row++, dst += pitch) {
+        Uint8 bits = sprite[row] & mask;
+        for (int col = 0; bits; col++, bits <<= 1) {
+            if (bits & 0x80) dst[col] = color;
+        }
+    }
+}
+
+#ifdef BLIT_X86
+__attribute__((target("sse2")))
+static void blit_rows_sse2(Uint32 *dst, int pitch, const Uint8 *sprite, int height, Uint8 mask, Uint32 color) {
+    const __m128i c = _mm_set1_epi32((int)color);
+    const __m128i sel_lo = _mm_set_epi32(0x10, 0x20, 0x40, 0x80); // Lane 0 is bit 7
+    const __m128i sel_hi = _mm_set_epi32(0x01, 0x02, 0x04, 0x08);
+
+    for (int row = 0; row < height; row++, dst += pitch) {
+        Uint8 bits = sprite[row] & mask;
+        if (!bits) continue;
+        __m128i b = _mm_set1_epi32(bits);
+        // Only touch a half that has set bits, so 4-wide sprites never read past x + 4
+        if (bits & 0xF0) {
+            __m128i m = _mm_cmpeq_epi32(_mm_and_si128(b, sel_lo), sel_lo);
+            __m128i d = _mm_loadu_si128((__m128i *)dst);
+            _mm_storeu_si128((__m128i *)dst, _mm_or_si128(_mm_and_si128(m, c), _mm_andnot_si128(m, d)));
+        }
+        if (bits & 0x0F) {
+            __m128i m = _mm_cmpeq_epi32(_mm_and_si128(b, sel_hi), sel_hi);
+            __m128i d = _mm_loadu_si128((__m128i *)(dst + 4));
+            _mm_storeu_si128((__m128i *)(dst + 4), _mm_or_si128(_mm_and_si128(m, c), _mm_andnot_si128(m, d)));
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+static void blit_rows_avx2(Uint32 *dst, int pitch, const Uint8 *sprite, int height, Uint8 mask, Uint32 color) {
+    const __m256i c = _mm256_set1_epi32((int)color);
+    const __m256i sel = _mm256_set_epi32(0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80);
+
+    for (int row = 0; row < height; row++, dst += pitch) {
+        Uint8 bits = sprite[row] & mask;
+        if (!bits) continue;
+        __m256i m = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(bits), sel), sel);
+        _mm256_maskstore_epi32((int *)dst, m, c); // Masked-off lanes are never written
+    }
+}
+#endif
+
+static BlitRowsFn blit_rows;
+
+static BlitRowsFn pick_blit_rows(void) {
+#ifdef BLIT_X86
+    if (SDL_HasAVX2()) return blit_rows_avx2;
+    if (SDL_HasSSE2()) return blit_rows_sse2;
+#endif
+    return blit_rows_scalar;
+}
+
+void draw_sprite(int x, int y, const Uint8 *sprite, int width, int height, Uint32 color, Frame *frame) {
+    if (!blit_rows) blit_rows = pick_blit_rows();
+
+    // Clip rows once instead of testing every pixel
+    int first_row = y < 0 ? -y : 0;
+    int last_row = y + height > frame->height ? frame->height - y : height;
+    if (first_row >= last_row || x >= frame->width || x + width <= 0) return;
+    mark_dirty(frame, x, y, width, height);
+    if (frame->deferred && raster_push_sprite(frame, x, y, sprite, width, height, 0, color)) return;
+
+    Uint8 mask = width_mask(width);
+    Uint32 *dst = frame->pixels + (y + first_row) * frame->pitch + x;
+
+    // Fast path: the vector span (4 or 8 pixels) lies inside the row
+    int span = width > 4 ? 8 : 4;
+    if (x >= 0 && x + span <= frame->width) {
+        blit_rows(dst, frame->pitch, sprite + first_row, last_row - first_row, mask, color);
+        return;
+    }
+
+    // Left/right edge: drop the columns that fall outside the frame
+    int first_col = x < 0 ? -x : 0;
+    int last_col = x + width > frame->width ? frame->width - x : width;
+    for (int row = first_row; row < last_row; row++, dst += frame->pitch) {
+        Uint8 bits = sprite[row] & mask;
+        for (int col = first_col; col < last_col; col++) {
+            if (bits & (0x80 >> col)) dst[col] = color;
+        }
+    }
+}
+
+// Fill n pixels with one color
+static void fill_span(Uint32 *dst, int n, Uint32 color) {
+    int i = 0;
+#ifdef BLIT_X86
+    __m128i c = _mm_set1_epi32((int)color);
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_si128((__m128i *)(dst + i), c);
+    }
+#endif
+    for (; i < n; i++) {
+        dst[i] = color;
+    }
+}
+
+void draw_sprite_scaled(int x, int y, const Uint8 *sprite, int width, int height, int scale, Uint32 color, Frame *frame) {
+    int clip_left = x < 0 ? -x : 0;
+    int clip_right = x + width * scale > frame->width ? frame->width - x : width * scale;
+    if (clip_left >= clip_right) return;
+    mark_dirty(frame, x, y, width * scale, height * scale);
+    if (frame->deferred && raster_push_sprite(frame, x, y, sprite, width, height, scale, color)) return;
+    Uint8 mask = width_mask(width);
+
+    for (int row = 0; row < height; row++) {
+        Uint8 bits = sprite[row] & mask;
+        if (!bits) continue;
+        int top = y + row * scale;
+        int bottom = top + scale;
+        if (top < 0) top = 0;
+        if (bottom > frame->height) bottom = frame->height;
+        if (top >= bottom) continue;
+
+        // Turn runs of set bits into clipped pixel spans, then repeat them down the block
+        for (int col = 0; col < width;) {
+            if (!(bits & (0x80 >> col))) {
+                col++;
+                continue;
+            }
+            int run_start = col;
+            while (col < width && (bits & (0x80 >> col))) col++;
+            int left = run_start * scale;
+            int right = col * scale;
+            if (left < clip_left) left = clip_left;
+            if (right > clip_right) right = clip_right;
+            if (left >= right) continue;
+            for (int py = top; py < bottom; py++) {
+                fill_span(frame->pixels + py * frame->pitch + x + left, right - left, color);
+            }
+        }
+    }
+}
+
+
+// Masked copy of an image: opaque source pixels replace the frame. Copies
+// `n` pixels per row from rows `stride` apart in the image
+typedef void (*BlendRowsFn)(Uint32 *dst, int pitch, const Uint32 *src, const Uint32 *mask, int stride, int n, int height);
+
+static void blend_rows_scalar(Uint32 *dst, int pitch, const Uint32 *src, const Uint32 *mask, int stride, int n, int height) {
+    for (int row = 0; row < height; row++, dst += pitch, src += stride, mask += stride) {
+        for (int i = 0; i < n; i++) {
+            dst[i] = src[i] | (dst[i] & ~mask[i]);
+        }
+    }
+}
+
+#ifdef BLIT_X86
+__attribute__((target("sse2")))
+static void blend_rows_sse2(Uint32 *dst, int pitch, const Uint32 *src, const Uint32 *mask, int stride, int n, int height) {
+    for (int row = 0; row < height; row++, dst += pitch, src += stride, mask += stride) {
+        int i = 0;
+        for (; i + 4 <= n; i += 4) {
+            __m128i m = _mm_loadu_si128((const __m128i *)(mask + i));
+            __m128i s = _mm_loadu_si128((const __m128i *)(src + i));
+            __m128i d = _mm_loadu_si128((__m128i *)(dst + i));
+            _mm_storeu_si128((__m128i *)(dst + i), _mm_or_si128(s, _mm_andnot_si128(m, d)));
+        }
+        for (; i < n; i++) {
+            dst[i] = src[i] | (dst[i] & ~mask[i]);
+        }
+    }
+}
+
+// The mask doubles as the store mask, so the frame is never read
+__attribute__((target("avx2")))
+static void blend_rows_avx2(Uint32 *dst, int pitch, const Uint32 *src, const Uint32 *mask, int stride, int n, int height) {
+    for (int row = 0; row < height; row++, dst += pitch, src += stride, mask += stride) {
+        int i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256i m = _mm256_loadu_si256((const __m256i *)(mask + i));
+            _mm256_maskstore_epi32((int *)(dst + i), m, _mm256_loadu_si256((const __m256i *)(src + i)));
+        }
+        if (i + 4 <= n) {
+            __m128i m = _mm_loadu_si128((const __m128i *)(mask + i));
+            _mm_maskstore_epi32((int *)(dst + i), m, _mm_loadu_si128((const __m128i *)(src + i)));
+            i += 4;
+        }
+        for (; i < n; i++) {
+            dst[i] = src[i] | (dst[i] & ~mask[i]);
+        }
+    }
+}
+#endif
+
+static BlendRowsFn blend_rows;
+
+static BlendRowsFn pick_blend_rows(void) {
+#ifdef BLIT_X86
+    if (SDL_HasAVX2()) return blend_rows_avx2;
+    if (SDL_HasSSE2()) return blend_rows_sse2;
+#endif
+    return blend_rows_scalar;
+}
+
+void draw_image(int x, int y, const Uint32 *pixels, const Uint32 *mask, int width, int height, Frame *frame) {
+    if (!blend_rows) blend_rows = pick_blend_rows();
+
+    int first_row = y < 0 ? -y : 0;
+    int last_row = y + height > frame->height ? frame->height - y : height;
+    int first_col = x < 0 ? -x : 0;
+    int last_col = x + width > frame->width ? frame->width - x : width;
+    if (first_row >= last_row || first_col >= last_col) return;
+    mark_dirty(frame, x, y, width, height);
+    if (frame->deferred && raster_push_image(frame, x, y, pixels, mask, width, height)) return;
+
+    int offset = first_row * width + first_col;
+    blend_rows(frame->pixels + (y + first_row) * frame->pitch + x + first_col, frame->pitch,
+               pixels + offset, mask + offset, width, last_col - first_col, last_row - first_row);
+}
+
+void draw_points(int x, int y, const int *xs, const int *ys, const Uint32 *colors, int count, int size, Frame *frame) {
+    if (count <= 0 || size <= 0) return;
+
+    // Bounds, for the dirty rect (recording bins each point itself, and a
+    // band replaying the points needs neither)
+    if (!frame->dirty_full) {
+        int left = INT_MAX, top = INT_MAX, right = INT_MIN, bottom = INT_MIN;
+        for (int i = 0; i < count; i++) {
+            if (xs[i] < left) left = xs[i];
+            if (xs[i] > right) right = xs[i];
+            if (ys[i] < top) top = ys[i];
+            if (ys[i] > bottom) bottom = ys[i];
+        }
+        SDL_Rect bounds = {x + left, y + top, right - left + size, bottom - top + size};
+        SDL_Rect screen = {0, 0, frame->width, frame->height};
+        if (!SDL_HasIntersection(&bounds, &screen)) return;
+        mark_dirty(frame, bounds.x, bounds.y, bounds.w, bounds.h);
+    }
+    if (frame->deferred && raster_push_points(frame, x, y, xs, ys, colors, count, size)) return;
+
+    if (size == 1) {
+        for (int i = 0; i < count; i++) {
+            int px = x + xs[i], py = y + ys[i];
+            if ((unsigned)px < (unsigned)frame->width && (unsigned)py < (unsigned)frame->height) {
+                frame->pixels[py * frame->pitch + px] = colors[i];
+            }
+        }
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        int x0 = x + xs[i], y0 = y + ys[i];
+        int x1 = x0 + size > frame->width ? frame->width : x0 + size;
+        int y1 = y0 + size > frame->height ? frame->height : y0 + size;
+        if (x0 < 0) x0 = 0;
+        if (y0 < 0) y0 = 0;
+        for (int py = y0; py < y1; py++) {
+            for (int px = x0; px < x1; px++) frame->pixels[py * frame->pitch + px] = colors[i];
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,26 @@
+#ifndef BLIT_H
+#define BLIT_H
+
+#include <SDL2/SDL.h>
+#include "frame.h"
+
+// 1bpp sprite blitter. Each sprite row is one byte, bit 7 is the leftmost
+// pixel, set bits are drawn in color and clear bits leave the frame alone.
+// Width is at most 8; pixels outside the frame are clipped and the drawn
+// area is marked dirty.
+void draw_sprite(int x, int y, const Uint8 *sprite, int width, int height, Uint32 color, Frame *frame);
+
+// Same, but every sprite pixel becomes a scale x scale block at (x, y)
+void draw_sprite_scaled(int x, int y, const Uint8 *sprite, int width, int height, int scale, Uint32 color, Frame *frame);
+
+// Pre-expanded RGBA image (width x height, rows packed). `mask` is
+// 0xFFFFFFFF where the image is opaque and 0 where the frame shows through;
+// `pixels` must be 0 wherever `mask` is. Clipped and marked dirty like sprites
+void draw_image(int x, int y, const Uint32 *pixels, const Uint32 *mask, int width, int height, Frame *frame);
+
+// `count` points, point i a size x size square of colors[i] with its
+// top-left at (x + xs[i], y + ys[i]). Clipped and marked dirty (as one
+// rect around them all) like sprites
+void draw_points(int x, int y, const int *xs, const int *ys, const Uint32 *colors, int count, int size, Frame *frame);
+
+#endif // BLIT_H
@@ -0,0 +1,169 @@
+#include <SDL2/SDL.h>
+#include "frame.h"
+#include "blit.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define FRAME_WIDTH 800
+#define FRAME_HEIGHT 600
+#define BLITS 2000000
+
+// Lander sprite (8x8)
+static const Uint8 sprite_8x8[8] = {
+    0b00011000, 0b00111100, 0b01111110, 0b11111111,
+    0b11011011, 0b10011001, 0b01000010, 0b00100100
+};
+
+// Flame sprite (4x4)
+static const Uint8 sprite_4x4[4] = {
+    0b01100000, 0b11110000, 0b01100000, 0b00100000
+};
+
+// Pitfall walk frame (8x8, drawn at 4x scale = 32x32)
+static const Uint8 sprite_pitfall[8] = {
+    0b00110000, 0b00110000, 0b01111000, 0b00110000,
+    0b00110000, 0b01000100, 0b00101000, 0b00010000
+};
+
+// Per-pixel blitter the games used before, kept as the correctness reference
+static void reference_blit(int x, int y, const Uint8 *sprite, int width, int height, int scale, Uint32 color, Frame *frame) {
+    for (int row = 0; row < height * scale; row++) {
+        if (y + row < 0 || y + row >= frame->height) continue;
+        Uint8 bits = sprite[row / scale];
+        for (int col = 0; col < width * scale; col++) {
+            if (x + col < 0 || x + col >= frame->width) continue;
+            if (bits & (1 << (7 - col / scale))) {
+                frame->pixels[(y + row) * frame->pitch + (x + col)] = color;
+            }
+        }
+    }
+}
+
+static void blit(int x, int y, const Uint8 *sprite, int width, int height, int scale, Uint32 color, Frame *frame) {
+    if (scale == 1) {
+        draw_sprite(x, y, sprite, width, height, color, frame);
+    } else {
+        draw_sprite_scaled(x, y, sprite, width, height, scale, color, frame);
+    }
+}
+
+// Blit at every position around the frame edges and compare against the reference
+static int check_case(const Uint8 *sprite, int width, int height, int scale, Frame *a, Frame *b) {
+    int size_x = width * scale, size_y = height * scale;
+    int xs[] = {-size_x - 1, -size_x, -size_x + 1, -3, -1, 0, 1, 17, FRAME_WIDTH / 2,
+                FRAME_WIDTH - size_x - 1, FRAME_WIDTH - size_x, FRAME_WIDTH - 8, FRAME_WIDTH - 5,
+                FRAME_WIDTH - 4, FRAME_WIDTH - 1, FRAME_WIDTH};
+    int ys[] = {-size_y, -size_y + 1, -1, 0, 1, FRAME_HEIGHT / 2, FRAME_HEIGHT - size_y,
+                FRAME_HEIGHT - 1, FRAME_HEIGHT};
+    for (size_t i = 0; i < SDL_arraysize(xs); i++) {
+        for (size_t j = 0; j < SDL_arraysize(ys); j++) {
+            Uint32 color = 0x10000000u + (Uint32)(i * 64 + j);
+            reference_blit(xs[i], ys[j], sprite, width, height, scale, color, a);
+            blit(xs[i], ys[j], sprite, width, height, scale, color, b);
+        }
+    }
+    return memcmp(a->pixels, b->pixels, sizeof(Uint32) * FRAME_WIDTH * FRAME_HEIGHT) == 0;
+}
+
+static double time_case(const Uint8 *sprite, int width, int height, int scale, int use_reference, Frame *frame) {
+    int max_x = FRAME_WIDTH - width * scale, max_y = FRAME_HEIGHT - height * scale;
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int i = 0; i < BLITS; i++) {
+        int x = (int)((i * 7919u) % (unsigned)max_x), y = (int)((i * 104729u) % (unsigned)max_y);
+        if (use_reference) {
+            reference_blit(x, y, sprite, width, height, scale, 0xFFFF00FF, frame);
+        } else {
+            blit(x, y, sprite, width, height, scale, 0xFFFF00FF, frame);
+        }
+    }
+    return (SDL_GetPerformanceCounter() - start) * 1e9 / SDL_GetPerformanceFrequency() / BLITS;
+}
+
+// 8x8 sprite expanded into a 12x12 RGBA image with a 2 pixel border, the
+// way the lander's rotation cache stores it
+#define IMAGE_SIZE 12
+static Uint32 image_pixels[IMAGE_SIZE * IMAGE_SIZE];
+static Uint32 image_mask[IMAGE_SIZE * IMAGE_SIZE];
+
+static void expand_image(const Uint8 *sprite, Uint32 color) {
+    for (int row = 0; row < IMAGE_SIZE; row++) {
+        for (int col = 0; col < IMAGE_SIZE; col++) {
+            int sx = col - 2, sy = row - 2;
+            int set = sx >= 0 && sx < 8 && sy >= 0 && sy < 8 && (sprite[sy] & (0x80 >> sx));
+            image_mask[row * IMAGE_SIZE + col] = set ? 0xFFFFFFFFu : 0;
+            image_pixels[row * IMAGE_SIZE + col] = set ? color : 0;
+        }
+    }
+}
+
+// Same edge positions as check_case, against the reference drawing the plain sprite
+static int check_image(Frame *a, Frame *b) {
+    int xs[] = {-IMAGE_SIZE - 1, -IMAGE_SIZE, -7, -3, -1, 0, 1, FRAME_WIDTH / 2,
+                FRAME_WIDTH - IMAGE_SIZE, FRAME_WIDTH - 5, FRAME_WIDTH - 1, FRAME_WIDTH};
+    int ys[] = {-IMAGE_SIZE, -3, 0, FRAME_HEIGHT / 2, FRAME_HEIGHT - IMAGE_SIZE, FRAME_HEIGHT - 1, FRAME_HEIGHT};
+    for (size_t i = 0; i < SDL_arraysize(xs); i++) {
+        for (size_t j = 0; j < SDL_arraysize(ys); j++) {
+            Uint32 color = 0x20000000u + (Uint32)(i * 64 + j);
+            expand_image(sprite_8x8, color);
+            reference_blit(xs[i] + 2, ys[j] + 2, sprite_8x8, 8, 8, 1, color, a);
+            draw_image(xs[i], ys[j], image_pixels, image_mask, IMAGE_SIZE, IMAGE_SIZE, b);
+        }
+    }
+    return memcmp(a->pixels, b->pixels, sizeof(Uint32) * FRAME_WIDTH * FRAME_HEIGHT) == 0;
+}
+
+static double time_image(Frame *frame) {
+    int max_x = FRAME_WIDTH - IMAGE_SIZE, max_y = FRAME_HEIGHT - IMAGE_SIZE;
+    expand_image(sprite_8x8, 0xFFFF00FF);
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int i = 0; i < BLITS; i++) {
+        int x = (int)((i * 7919u) % (unsigned)max_x), y = (int)((i * 104729u) % (unsigned)max_y);
+        draw_image(x, y, image_pixels, image_mask, IMAGE_SIZE, IMAGE_SIZE, frame);
+    }
+    return (SDL_GetPerformanceCounter() - start) * 1e9 / SDL_GetPerformanceFrequency() / BLITS;
+}
+
+int main(int argc, char *argv[]) {
+    Uint32 *buffer_a = calloc(FRAME_WIDTH * FRAME_HEIGHT, sizeof(Uint32));
+    Uint32 *buffer_b = calloc(FRAME_WIDTH * FRAME_HEIGHT, sizeof(Uint32));
+    if (!buffer_a || !buffer_b) {
+        printf("Out of memory\n");
+        return 1;
+    }
+    // Frames start fully dirty so the timings cover the blit alone, not rect tracking
+    Frame a = {.pixels = buffer_a, .pitch = FRAME_WIDTH, .width = FRAME_WIDTH, .height = FRAME_HEIGHT, .dirty_full = 1};
+    Frame b = {.pixels = buffer_b, .pitch = FRAME_WIDTH, .width = FRAME_WIDTH, .height = FRAME_HEIGHT, .dirty_full = 1};
+
+    struct {
+        const char *name;
+        const Uint8 *sprite;
+        int width, height, scale;
+    } cases[] = {
+        {"8x8", sprite_8x8, 8, 8, 1},
+        {"4x4", sprite_4x4, 4, 4, 1},
+        {"32x32 (8x8 @4x)", sprite_pitfall, 8, 8, 4},
+    };
+
+    printf("SIMD path: %s\n", SDL_HasAVX2() ? "AVX2" : SDL_HasSSE2() ? "SSE2" : "scalar");
+    int failed = 0;
+    for (size_t i = 0; i < SDL_arraysize(cases); i++) {
+        int match = check_case(cases[i].sprite, cases[i].width, cases[i].height, cases[i].scale, &a, &b);
+        double ref_ns = time_case(cases[i].sprite, cases[i].width, cases[i].height, cases[i].scale, 1, &a);
+        double new_ns = time_case(cases[i].sprite, cases[i].width, cases[i].height, cases[i].scale, 0, &b);
+        printf("%-16s %s  reference %7.2f ns/blit  blitter %7.2f ns/blit  (%.1fx)\n", cases[i].name,
+               match ? "match   " : "MISMATCH", ref_ns, new_ns, ref_ns / new_ns);
+        failed |= !match;
+    }
+
+    // Rotated lander frames are pre-expanded images; they should cost about what a sprite does
+    int match = check_image(&a, &b);
+    double sprite_ns = time_case(sprite_8x8, 8, 8, 1, 0, &a);
+    double image_ns = time_image(&b);
+    printf("%-16s %s  8x8 sprite %7.2f ns/blit  image %7.2f ns/blit\n", "12x12 RGBA image",
+           match ? "match   " : "MISMATCH", sprite_ns, image_ns);
+    failed |= !match;
+
+    free(buffer_a);
+    free(buffer_b);
+    return failed;
+}
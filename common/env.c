@@ -0,0 +1,100 @@
+#include "env.h"
+#include "workers.h"
+#include "rng.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Batches are whole cache lines of a game's per-instance float arrays, so
+// threads stepping neighbouring batches don't share lines
+#define BATCH_ALIGN 16
+
+struct Env {
+    int count;
+    void *instances; // The game's
+    WorkerPool *pool;
+    int batch;       // Instances per batch handed to a thread
+
+    // The call being run
+    const Uint8 *actions;
+    float *rewards;
+    Uint8 *dones;
+    float *observations;
+};
+
+Env *env_create(int n, unsigned int seed, int threads) {
+    if (n < 1) {
+        printf("An environment needs at least one instance\n");
+        return NULL;
+    }
+    Env *env = calloc(1, sizeof(Env));
+    Uint32 *seeds = malloc(n * sizeof(Uint32));
+    if (!env || !seeds) {
+        printf("Out of memory for %d %s instances\n", n, env_game.name);
+        free(env);
+        free(seeds);
+        return NULL;
+    }
+    env->pool = workers_create(threads);
+    if (!env->pool) {
+        free(seeds);
+        env_destroy(env);
+        return NULL;
+    }
+    // Enough batches per thread to even out rounds that end at different times
+    env->batch = (n / (threads * 16) + BATCH_ALIGN - 1) / BATCH_ALIGN * BATCH_ALIGN;
+    if (env->batch < BATCH_ALIGN) env->batch = BATCH_ALIGN;
+
+    // Each instance gets its own seed, drawn in order so it doesn't depend on threads
+    Rng rng;
+    rng_seed(&rng, seed);
+    for (int i = 0; i < n; i++) seeds[i] = rng_next(&rng);
+    env->instances = env_game.create(n, seed, seeds);
+    free(seeds);
+    if (!env->instances) {
+        env_destroy(env);
+        return NULL;
+    }
+    env->count = n;
+    return env;
+}
+
+void env_destroy(Env *env) {
+    if (!env) return;
+    if (env->instances) env_game.destroy(env->instances);
+    workers_destroy(env->pool);
+    free(env);
+}
+
+int env_count(const Env *env) {
+    return env->count;
+}
+
+int env_observation_size(void) {
+    return env_game.observation_size;
+}
+
+const char *env_name(void) {
+    return env_game.name;
+}
+
+static void step_batch(void *data, int first, int last) {
+    Env *env = data;
+    env_game.step(env->instances, first, last, env->actions, env->rewards, env->dones);
+}
+
+void env_step(Env *env, const Uint8 *actions, float *rewards, Uint8 *dones) {
+    env->actions = actions;
+    env->rewards = rewards;
+    env->dones = dones;
+    workers_run(env->pool, env->count, env->batch, step_batch, env);
+}
+
+static void observe_batch(void *data, int first, int last) {
+    Env *env = data;
+    env_game.observe(env->instances, first, last, env->observations + (size_t)first * env_game.observation_size);
+}
+
+void env_observe(Env *env, float *buf) {
+    env->observations = buf;
+    workers_run(env->pool, env->count, env->batch, observe_batch, env);
+}
\ No newline at end of file
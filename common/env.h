@@ -0,0 +1,55 @@
+#ifndef ENV_H
+#define ENV_H
+
+#include <SDL2/SDL.h>
+
+// Headless environments, for training bots and QA: N instances of a game
+// stepped together in one process, with no window and no sound. Every
+// instance runs fixed SIM_DT ticks from its own seed, so a run repeats
+// exactly whatever the thread count. Actions, rewards, done flags and
+// observations are flat arrays indexed by instance
+typedef struct Env Env;
+
+// Action bits: steer (or turn) left and right, fire the main engine
+#define ENV_LEFT 1
+#define ENV_RIGHT 2
+#define ENV_THRUST 4
+
+// Make `n` instances seeded from `seed`, stepped by `threads` threads
+// (counting the caller). Returns NULL on failure
+Env *env_create(int n, unsigned int seed, int threads);
+void env_destroy(Env *env);
+int env_count(const Env *env);
+// Floats env_observe writes per instance
+int env_observation_size(void);
+// Name of the game the environments run
+const char *env_name(void);
+
+// Run one tick of every instance with `actions[i]` held on instance i,
+// writing its reward and whether its round ended. An ended round restarts
+// at once, so the next observation is of the new round
+void env_step(Env *env, const Uint8 *actions, float *rewards, Uint8 *dones);
+// Write every instance's observation, env_observation_size() floats each
+void env_observe(Env *env, float *buf);
+
+// What a game supplies to run as an environment. Each game's env library
+// defines env_game. The game owns every instance's state, so it can keep it
+// in struct-of-arrays form, and steps and observes contiguous ranges of
+// instances (one range per batch a thread takes)
+typedef struct {
+    const char *name;
+    int observation_size; // Floats in one observation
+    // Make `n` instances, instance i seeded by seeds[i] and anything they
+    // share by `seed`. Returns NULL on failure
+    void *(*create)(int n, unsigned int seed, const Uint32 *seeds);
+    void (*destroy)(void *instances);
+    // One tick of instances [first, last), each with its action; a round that
+    // ends restarts at once
+    void (*step)(void *instances, int first, int last, const Uint8 *actions, float *rewards, Uint8 *dones);
+    // Observations of instances [first, last), written from `out` on
+    void (*observe)(const void *instances, int first, int last, float *out);
+} EnvGame;
+
+extern const EnvGame env_game;
+
+#endif // ENV_H
\ No newline at end of file
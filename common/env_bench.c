@@ -0,0 +1,78 @@
+#include "env.h"
+#include "rng.h"
+#include "hash.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Environment throughput: N instances flown by random actions (each held
+// for a few ticks), observed after every step the way a training loop
+// would. obs_hash covers every observation, so it must match across thread counts
+int main(int argc, char *argv[]) {
+    int envs = 1024, steps = 2000, threads = 1;
+    unsigned int seed = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--envs") == 0 && i + 1 < argc) {
+            envs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--steps") == 0 && i + 1 < argc) {
+            steps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        } else {
+            printf("Usage: %s [--envs N] [--steps N] [--threads N] [--seed S]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    Env *env = env_create(envs, seed, threads);
+    if (!env) return 1;
+    int obs_size = env_observation_size();
+    Uint8 *actions = calloc(envs, 1);
+    Uint8 *dones = calloc(envs, 1);
+    float *rewards = calloc(envs, sizeof(float));
+    float *observations = calloc((size_t)envs * obs_size, sizeof(float));
+    if (!actions || !dones || !rewards || !observations) {
+        printf("Out of memory\n");
+        env_destroy(env);
+        return 1;
+    }
+
+    Rng rng;
+    rng_seed(&rng, seed);
+    Uint32 hash = HASH_INIT;
+    long long rounds = 0;
+    double reward = 0.0;
+    double step_seconds = 0.0;
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int s = 0; s < steps; s++) {
+        for (int i = 0; i < envs; i++) {
+            Uint32 r = rng_next(&rng);
+            if ((r & 7) == 0) actions[i] = (Uint8)((r >> 3) & 7); // New action about every 8 ticks
+        }
+        Uint64 t = SDL_GetPerformanceCounter();
+        env_step(env, actions, rewards, dones);
+        env_observe(env, observations);
+        step_seconds += (SDL_GetPerformanceCounter() - t) / (double)SDL_GetPerformanceFrequency();
+        for (int i = 0; i < envs; i++) {
+            rounds += dones[i];
+            reward += rewards[i];
+        }
+        hash = hash_bytes(hash, observations, (size_t)envs * obs_size * sizeof(float));
+    }
+    double seconds = (SDL_GetPerformanceCounter() - start) / (double)SDL_GetPerformanceFrequency();
+
+    double total = (double)envs * steps;
+    printf("{\"game\": \"%s\", \"envs\": %d, \"steps\": %d, \"threads\": %d, \"seconds\": %.3f, "
+           "\"steps_per_second\": %.0f, \"ns_per_step\": %.1f, \"rounds\": %lld, \"mean_reward\": %.4f, \"obs_hash\": \"%08x\"}\n",
+           env_name(), envs, steps, threads, seconds, total / step_seconds, step_seconds * 1e9 / total, rounds,
+           reward / total, hash);
+
+    free(actions);
+    free(dones);
+    free(rewards);
+    free(observations);
+    env_destroy(env);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,233 @@
+#include "frame.h"
+#include "raster.h"
+#include "trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Only one frame is ever in flight
+static Frame frame;
+
+Frame *begin_frame(SDL_Texture *texture) {
+    int width, height;
+    if (SDL_QueryTexture(texture, NULL, NULL, &width, &height) < 0) {
+        printf("Texture query failed: %s\n", SDL_GetError());
+        return NULL;
+    }
+
+    // (Re)allocate the backbuffer when the texture size changes
+    if (!frame.pixels || width != frame.width || height != frame.height) {
+        raster_discard(); // Drawing recorded for the old buffer
+        free(frame.pixels);
+        frame.pixels = calloc((size_t)width * height, sizeof(Uint32));
+        if (!frame.pixels) {
+            printf("Backbuffer allocation failed\n");
+            return NULL;
+        }
+        frame.pitch = width;
+        frame.width = width;
+        frame.height = height;
+        frame.dirty_full = 1;
+    }
+    frame.texture = texture;
+    frame.deferred = raster_threads() > 1;
+    return &frame;
+}
+
+void end_frame(Frame *frame) {
+    Uint64 trace_start = trace_begin();
+    if (frame->deferred) raster_flush(frame);
+    trace_end("raster", trace_start);
+
+    trace_start = trace_begin();
+    int pitch_bytes = frame->pitch * sizeof(Uint32);
+    int area = 0;
+    for (int i = 0; i < frame->dirty_count; i++) {
+        area += frame->dirty[i].w * frame->dirty[i].h;
+    }
+
+    if (frame->dirty_full || area * 100 > frame->width * frame->height * FULL_UPLOAD_PERCENT) {
+        SDL_UpdateTexture(frame->texture, NULL, frame->pixels, pitch_bytes);
+    } else {
+        for (int i = 0; i < frame->dirty_count; i++) {
+            SDL_Rect *r = &frame->dirty[i];
+            SDL_UpdateTexture(frame->texture, r, frame->pixels + r->y * frame->pitch + r->x, pitch_bytes);
+        }
+    }
+    frame->dirty_count = 0;
+    frame->dirty_full = 0;
+    trace_end("upload", trace_start);
+}
+
+void destroy_frame(void) {
+    raster_discard();
+    free(frame.pixels);
+    frame.pixels = NULL;
+}
+
+Uint32 frame_checksum(void) {
+    Uint32 hash = 2166136261u; // FNV-1a over the pixels
+    for (int y = 0; frame.pixels && y < frame.height; y++) {
+        const Uint32 *row = frame.pixels + y * frame.pitch;
+        for (int x = 0; x < frame.width; x++) {
+            for (int shift = 0; shift < 32; shift += 8) hash = (hash ^ ((row[x] >> shift) & 0xFF)) * 16777619u;
+        }
+    }
+    return hash;
+}
+
+// Overlapping or sharing an edge
+static int rects_touch(const SDL_Rect *a, const SDL_Rect *b) {
+    return a->x <= b->x + b->w && b->x <= a->x + a->w &&
+           a->y <= b->y + b->h && b->y <= a->y + a->h;
+}
+
+void mark_dirty(Frame *frame, int x, int y, int w, int h) {
+    if (frame->dirty_full) return;
+    SDL_Rect rect = {x, y, w, h};
+    SDL_Rect bounds = {0, 0, frame->width, frame->height};
+    if (!SDL_IntersectRect(&rect, &bounds, &rect)) return;
+
+    for (;;) {
+        // Absorb every rect the new one touches; the union may reach others, so rescan
+        for (int i = 0; i < frame->dirty_count;) {
+            if (rects_touch(&frame->dirty[i], &rect)) {
+                SDL_UnionRect(&frame->dirty[i], &rect, &rect);
+                frame->dirty[i] = frame->dirty[--frame->dirty_count];
+                i = 0;
+            } else {
+                i++;
+            }
+        }
+        if (frame->dirty_count < MAX_DIRTY_RECTS) break;
+
+        // List is full: merge with the rect whose union grows the least
+        int best = 0, best_growth = 0;
+        for (int i = 0; i < frame->dirty_count; i++) {
+            SDL_Rect u;
+            SDL_UnionRect(&frame->dirty[i], &rect, &u);
+            int growth = u.w * u.h - frame->dirty[i].w * frame->dirty[i].h;
+            if (i == 0 || growth < best_growth) {
+                best = i;
+                best_growth = growth;
+            }
+        }
+        SDL_UnionRect(&frame->dirty[best], &rect, &rect);
+        frame->dirty[best] = frame->dirty[--frame->dirty_count];
+    }
+    frame->dirty[frame->dirty_count++] = rect;
+}
+
+void clear_frame(Frame *frame, Uint32 color) {
+    if (frame->deferred && raster_push_fill(frame, 0, 0, frame->width, frame->height, color)) {
+        frame->dirty_full = 1;
+        frame->dirty_count = 0;
+        return;
+    }
+    for (int y = 0; y < frame->height; y++) {
+        Uint32 *row = frame->pixels + y * frame->pitch;
+        for (int x = 0; x < frame->width; x++) {
+            row[x] = color;
+        }
+    }
+    frame->dirty_full = 1;
+    frame->dirty_count = 0;
+}
+
+void fill_rect(Frame *frame, int x, int y, int w, int h, Uint32 color) {
+    int x0 = x < 0 ? 0 : x;
+    int y0 = y < 0 ? 0 : y;
+    int x1 = x + w > frame->width ? frame->width : x + w;
+    int y1 = y + h > frame->height ? frame->height : y + h;
+    if (x0 >= x1 || y0 >= y1) return;
+    mark_dirty(frame, x0, y0, x1 - x0, y1 - y0);
+    if (frame->deferred && raster_push_fill(frame, x0, y0, x1 - x0, y1 - y0, color)) return;
+
+    for (int py = y0; py < y1; py++) {
+        Uint32 *row = frame->pixels + py * frame->pitch;
+        for (int px = x0; px < x1; px++) {
+            row[px] = color;
+        }
+    }
+}
+
+void fill_columns(Frame *frame, int x, int y, int w, int h, const int *top, const int *bottom, Uint32 color) {
+    int x0 = x < 0 ? 0 : x;
+    int y0 = y < 0 ? 0 : y;
+    int x1 = x + w > frame->width ? frame->width : x + w;
+    int y1 = y + h > frame->height ? frame->height : y + h;
+    if (x0 >= x1 || y0 >= y1) return;
+
+    // Rows actually filled, for the dirty rect
+    int first = y1, last = y0;
+    for (int px = x0; px < x1; px++) {
+        int t = top && top[px - x] > y0 ? top[px - x] : y0;
+        int b = bottom && bottom[px - x] < y1 ? bottom[px - x] : y1;
+        if (t >= b) continue;
+        if (t < first) first = t;
+        if (b > last) last = b;
+    }
+    if (first >= last) return;
+    mark_dirty(frame, x0, first, x1 - x0, last - first);
+    if (frame->deferred && raster_push_columns(frame, x, y, w, h, top, bottom, color)) return;
+
+    // Row by row, so writes stay sequential
+    for (int py = first; py < last; py++) {
+        Uint32 *row = frame->pixels + py * frame->pitch;
+        for (int px = x0; px < x1; px++) {
+            if ((!top || py >= top[px - x]) && (!bottom || py < bottom[px - x])) row[px] = color;
+        }
+    }
+}
+
+Frame *create_layer(int width, int height) {
+    Frame *layer = calloc(1, sizeof(Frame));
+    Uint32 *pixels = calloc((size_t)width * height, sizeof(Uint32));
+    if (!layer || !pixels) {
+        printf("Layer allocation failed\n");
+        free(layer);
+        free(pixels);
+        return NULL;
+    }
+    layer->pixels = pixels;
+    layer->pitch = width;
+    layer->width = width;
+    layer->height = height;
+    layer->dirty_full = 1; // Never uploaded, so nothing to track
+    return layer;
+}
+
+void destroy_layer(Frame *layer) {
+    if (!layer) return;
+    free(layer->pixels);
+    free(layer);
+}
+
+void copy_rect(Frame *frame, const Frame *layer, int x, int y, int w, int h) {
+    int x0 = x < 0 ? 0 : x;
+    int y0 = y < 0 ? 0 : y;
+    int x1 = x + w > frame->width ? frame->width : x + w;
+    int y1 = y + h > frame->height ? frame->height : y + h;
+    if (x1 > layer->width) x1 = layer->width;
+    if (y1 > layer->height) y1 = layer->height;
+    if (x0 >= x1 || y0 >= y1) return;
+    mark_dirty(frame, x0, y0, x1 - x0, y1 - y0);
+    if (frame->deferred && raster_push_copy(frame, layer, x0, y0, x1 - x0, y1 - y0)) return;
+
+    for (int py = y0; py < y1; py++) {
+        memcpy(frame->pixels + py * frame->pitch + x0, layer->pixels + py * layer->pitch + x0, (x1 - x0) * sizeof(Uint32));
+    }
+}
+
+void shift_rows_left(Frame *frame, int y, int h, int dx) {
+    int y0 = y < 0 ? 0 : y;
+    int y1 = y + h > frame->height ? frame->height : y + h;
+    if (y0 >= y1 || dx <= 0 || dx >= frame->width) return;
+    mark_dirty(frame, 0, y0, frame->width - dx, y1 - y0);
+    if (frame->deferred && raster_push_shift(frame, y0, y1 - y0, dx)) return;
+
+    for (int py = y0; py < y1; py++) {
+        Uint32 *row = frame->pixels + py * frame->pitch;
+        memmove(row, row + dx, (frame->width - dx) * sizeof(Uint32));
+    }
+}
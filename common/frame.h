@@ -0,0 +1,57 @@
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <SDL2/SDL.h>
+
+// Dirty regions tracked per frame before falling back to merging them
+#define MAX_DIRTY_RECTS 32
+// Upload the whole texture once this share of the frame has changed
+#define FULL_UPLOAD_PERCENT 50
+
+// Persistent backbuffer the games draw into; changed regions are
+// uploaded to the texture in end_frame
+typedef struct {
+    Uint32 *pixels;       // Backbuffer memory
+    int pitch;            // Row length in pixels (not bytes)
+    int width, height;    // Texture size
+    SDL_Texture *texture; // Texture the backbuffer is uploaded to
+    SDL_Rect dirty[MAX_DIRTY_RECTS]; // Regions changed since the last upload, never overlapping
+    int dirty_count;
+    int dirty_full;       // Whole frame changed, rects are not tracked
+    int deferred;         // Drawing is recorded and rasterized by end_frame (raster.h)
+} Frame;
+
+// Start drawing a frame; the backbuffer keeps its contents between frames.
+// Draw only through the functions here and in blit.h: with more than one
+// rasterizer thread, pixels aren't written until end_frame
+Frame *begin_frame(SDL_Texture *texture);
+// Rasterize, then upload the dirty regions so the texture can be copied to the renderer
+void end_frame(Frame *frame);
+// Release the backbuffer
+void destroy_frame(void);
+// Hash of the backbuffer as of the last end_frame, to check renderers agree
+Uint32 frame_checksum(void);
+
+// Record a region written directly through frame->pixels
+void mark_dirty(Frame *frame, int x, int y, int w, int h);
+
+// Fill the whole frame with one color
+void clear_frame(Frame *frame, Uint32 color);
+// Fill a rectangle, clipped to the frame
+void fill_rect(Frame *frame, int x, int y, int w, int h, Uint32 color);
+// Fill column x + i of the rectangle from row top[i] down to (not including)
+// bottom[i]; a NULL top or bottom means the rectangle's edge
+void fill_columns(Frame *frame, int x, int y, int w, int h, const int *top, const int *bottom, Uint32 color);
+// Move rows [y, y + h) left by dx pixels (the rightmost dx keep their pixels)
+void shift_rows_left(Frame *frame, int y, int h, int dx);
+
+// Layers are offscreen frames (never uploaded, always drawn directly) for
+// what doesn't change: draw a layer once with the functions above, then
+// copy it back into the frame wherever something moved off it
+Frame *create_layer(int width, int height);
+void destroy_layer(Frame *layer);
+// Copy a rectangle of `layer` to the same place in the frame. The layer
+// must not change until end_frame
+void copy_rect(Frame *frame, const Frame *layer, int x, int y, int w, int h);
+
+#endif // FRAME_H
@@ -0,0 +1,18 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <SDL2/SDL.h>
+#include <stddef.h>
+
+// FNV-1a, for checksums that must agree between runs (and between the
+// processes of a netplay session). Hash fields, never whole structs: padding
+// bytes are whatever the stack held
+#define HASH_INIT 2166136261u
+
+static inline Uint32 hash_bytes(Uint32 hash, const void *data, size_t size) {
+    const Uint8 *bytes = data;
+    for (size_t i = 0; i < size; i++) hash = (hash ^ bytes[i]) * 16777619u;
+    return hash;
+}
+
+#endif // HASH_H
\ No newline at end of file
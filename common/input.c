@@ -0,0 +1,200 @@
+#include "input.h"
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Recording format: header, then runs of identical ticks, each as
+// varint(ticks) varint(held ^ previous held) varint(pressed)
+static const char MAGIC[4] = {'F', 'P', 'R', 'P'};
+#define VERSION 1
+
+static SDL_Scancode keys[INPUT_MAX_KEYS];
+static int key_count;
+static Uint8 held_keys[SDL_NUM_SCANCODES];
+static Uint32 held, pressed;   // This tick, one bit per tracked key
+static Uint32 pending_pressed; // Presses seen since the last tick
+
+// Recording: the run being extended and the held mask last written
+static FILE *record_file;
+static Uint32 run_held, run_pressed, run_ticks;
+static Uint32 written_held;
+
+// Replay: whole file in memory, decoded one run at a time
+static Uint8 *replay_data;
+static size_t replay_size, replay_pos;
+static Uint32 replay_ticks_left;
+static int replay_done;
+
+static void write_varint(FILE *file, Uint32 value) {
+    while (value >= 0x80) {
+        fputc((int)(value & 0x7F) | 0x80, file);
+        value >>= 7;
+    }
+    fputc((int)value, file);
+}
+
+// Returns 0 at the end of the data or on a truncated value
+static int read_varint(Uint32 *value) {
+    *value = 0;
+    for (int shift = 0; shift < 35 && replay_pos < replay_size; shift += 7) {
+        Uint8 byte = replay_data[replay_pos++];
+        *value |= (Uint32)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return 1;
+    }
+    return 0;
+}
+
+static void flush_run(void) {
+    if (!record_file || run_ticks == 0) return;
+    write_varint(record_file, run_ticks);
+    write_varint(record_file, run_held ^ written_held);
+    write_varint(record_file, run_pressed);
+    written_held = run_held;
+    run_ticks = 0;
+}
+
+static int open_recording(const char *path, unsigned int seed) {
+    record_file = fopen(path, "wb");
+    if (!record_file) {
+        printf("Failed to open recording %s\n", path);
+        return 0;
+    }
+    fwrite(MAGIC, 1, sizeof(MAGIC), record_file);
+    fputc(VERSION, record_file);
+    for (int i = 0; i < 4; i++) fputc((int)(seed >> (i * 8)) & 0xFF, record_file);
+    fputc(key_count, record_file);
+    for (int i = 0; i < key_count; i++) {
+        fputc((int)keys[i] & 0xFF, record_file);
+        fputc((int)(keys[i] >> 8) & 0xFF, record_file);
+    }
+    return 1;
+}
+
+static int open_replay(const char *path, unsigned int *seed) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        printf("Failed to open replay %s\n", path);
+        return 0;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    replay_data = size > 0 ? malloc((size_t)size) : NULL;
+    if (!replay_data || fread(replay_data, 1, (size_t)size, file) != (size_t)size) {
+        printf("Failed to read replay %s\n", path);
+        fclose(file);
+        free(replay_data);
+        replay_data = NULL;
+        return 0;
+    }
+    fclose(file);
+    replay_size = (size_t)size;
+
+    // Header must match this game's key layout
+    size_t header = sizeof(MAGIC) + 1 + 4 + 1 + 2 * (size_t)key_count;
+    int ok = replay_size >= header && memcmp(replay_data, MAGIC, sizeof(MAGIC)) == 0 &&
+             replay_data[4] == VERSION && replay_data[9] == key_count;
+    for (int i = 0; ok && i < key_count; i++) {
+        ok = (replay_data[10 + i * 2] | replay_data[11 + i * 2] << 8) == (int)keys[i];
+    }
+    if (!ok) {
+        printf("Replay %s was not recorded by this game\n", path);
+        free(replay_data);
+        replay_data = NULL;
+        return 0;
+    }
+    *seed = (unsigned int)replay_data[5] | (unsigned int)replay_data[6] << 8 |
+            (unsigned int)replay_data[7] << 16 | (unsigned int)replay_data[8] << 24;
+    replay_pos = header;
+    replay_ticks_left = 0;
+    replay_done = 0;
+    return 1;
+}
+
+int input_init(const SDL_Scancode *game_keys, int game_key_count,
+               const char *record_path, const char *replay_path, unsigned int *seed) {
+    if (game_key_count > INPUT_MAX_KEYS) {
+        printf("Too many input keys (%d, max %d)\n", game_key_count, INPUT_MAX_KEYS);
+        return 0;
+    }
+    memcpy(keys, game_keys, game_key_count * sizeof(SDL_Scancode));
+    key_count = game_key_count;
+    held = pressed = pending_pressed = 0;
+    memset(held_keys, 0, sizeof(held_keys));
+
+    if (replay_path && !open_replay(replay_path, seed)) return 0;
+    if (record_path && !open_recording(record_path, *seed)) return 0;
+    return 1;
+}
+
+void input_shutdown(void) {
+    if (record_file) {
+        flush_run();
+        fclose(record_file);
+        record_file = NULL;
+    }
+    free(replay_data);
+    replay_data = NULL;
+}
+
+void input_handle_event(const SDL_Event *event) {
+    if (event->type != SDL_KEYDOWN) return;
+    for (int i = 0; i < key_count; i++) {
+        if (event->key.keysym.scancode == keys[i]) pending_pressed |= 1u << i;
+    }
+}
+
+// Next tick from the replay; all keys up once it runs out
+static void replay_tick(void) {
+    if (replay_ticks_left == 0) {
+        Uint32 ticks, held_delta, run_pressed_bits;
+        if (!read_varint(&ticks) || !read_varint(&held_delta) || !read_varint(&run_pressed_bits) || ticks == 0) {
+            replay_done = 1;
+            held = pressed = 0;
+            return;
+        }
+        replay_ticks_left = ticks;
+        held ^= held_delta;
+        pressed = run_pressed_bits;
+    }
+    replay_ticks_left--;
+}
+
+int input_tick(void) {
+    if (replay_data) {
+        replay_tick();
+    } else {
+        const Uint8 *state = bench_keyboard_state();
+        held = 0;
+        for (int i = 0; i < key_count; i++) {
+            if (state[keys[i]]) held |= 1u << i;
+        }
+        pressed = pending_pressed;
+    }
+    pending_pressed = 0;
+
+    if (record_file && !replay_done) {
+        if (run_ticks > 0 && (held != run_held || pressed != run_pressed)) flush_run();
+        run_held = held;
+        run_pressed = pressed;
+        run_ticks++;
+    }
+    for (int i = 0; i < key_count; i++) held_keys[keys[i]] = (held >> i) & 1;
+    return !replay_done;
+}
+
+const Uint8 *input_keys(void) {
+    return held_keys;
+}
+
+int input_pressed(SDL_Scancode key) {
+    for (int i = 0; i < key_count; i++) {
+        if (keys[i] == key) return (pressed >> i) & 1;
+    }
+    return 0;
+}
+
+int input_replay_done(void) {
+    return replay_done;
+}
\ No newline at end of file
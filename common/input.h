@@ -0,0 +1,30 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <SDL2/SDL.h>
+
+// Most keys a game can track (one bit each in a recording)
+#define INPUT_MAX_KEYS 32
+
+// Track `keys`, and record every tick to `record_path` or play `replay_path`
+// back (either may be NULL). A replay replaces *seed with the recorded one
+int input_init(const SDL_Scancode *keys, int key_count,
+               const char *record_path, const char *replay_path, unsigned int *seed);
+// Flush and close the recording
+void input_shutdown(void);
+
+// Collect key presses (repeats included) for the next tick
+void input_handle_event(const SDL_Event *event);
+// Latch the input for one simulation tick: the live keys (recorded if asked)
+// or the next tick of the replay. Games read input only through this.
+// Returns 0 once a replay has run out; skip the tick so the run ends exactly
+int input_tick(void);
+
+// Keys held this tick, indexed by scancode (tracked keys only)
+const Uint8 *input_keys(void);
+// Key pressed (or auto-repeated) before this tick
+int input_pressed(SDL_Scancode key);
+// 1 once a replay has run out of ticks
+int input_replay_done(void);
+
+#endif // INPUT_H
\ No newline at end of file
@@ -0,0 +1,330 @@
+#include "netplay.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET NetSocket;
+#define close_socket closesocket
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int NetSocket;
+#define INVALID_SOCKET (-1)
+#define close_socket close
+#endif
+
+// Packet, little-endian: magic, session, the sender's tick, how far it runs
+// ahead of the newest tick it has heard of from us, how many of our inputs
+// it has (the ack), its newest confirmed hash and that hash's tick, then a
+// run of its inputs starting at `first`. Every packet repeats everything
+// unacknowledged, so a lost one costs nothing but time
+static const Uint8 MAGIC[4] = {'F', 'P', 'N', 'P'};
+#define HEADER_SIZE 33
+#define PACKET_INPUTS 128 // Most inputs in one packet
+#define PACKET_SIZE (HEADER_SIZE + PACKET_INPUTS)
+#define NO_HASH 0xFFFFFFFFu
+
+#define INPUT_RING 256    // Inputs kept per player (power of two)
+#define OUTBOX_SIZE 256   // Packets held back by lag_ms, one per millisecond
+#define TIMEOUT_MS 5000   // Silence before the peer counts as gone
+#define SYNC_INTERVAL 120 // Ticks between checks that neither side runs ahead
+
+static const NetGame *game;
+static int local_player;
+static Uint32 session;
+static int lag;
+static NetSocket sock = INVALID_SOCKET;
+static struct sockaddr_in peer_addr;
+
+// Ticks run so far: the live state is the one before tick `tick`, and the
+// state before tick t was saved in slot t % NET_STATE_SLOTS
+static int tick;
+static Uint8 local_inputs[INPUT_RING], remote_inputs[INPUT_RING];
+static Uint8 guessed[INPUT_RING];     // Peer input each tick ran with
+static int local_known, remote_known; // Inputs known for every tick before these
+static int peer_ack;                  // The peer has our inputs for every tick before this
+static int rollback_to;               // Earliest tick run on a wrong guess, -1 for none
+
+// Hashes of confirmed states (the state before tick t is confirmed once t <= remote_known)
+static Uint32 hashes[NET_STATE_SLOTS];
+static int hash_ticks[NET_STATE_SLOTS];
+static int hashed;           // Newest tick hashed, -1 for none
+static int peer_hash_tick;   // Peer's hash waiting for ours, -1 for none
+static Uint32 peer_hash;
+static int peer_hash_newest; // Hashes arriving out of order are older news
+
+// The peer's clock
+static int connected;
+static Uint32 last_heard;
+static int peer_tick, peer_lead;
+static int next_sync, sync_wait;
+static int warned_session;
+
+static struct {
+    Uint8 data[PACKET_SIZE];
+    int size;
+    Uint32 due;
+} outbox[OUTBOX_SIZE];
+static int outbox_first, outbox_count;
+
+static int rollbacks, replayed;
+
+static void put32(Uint8 *p, Uint32 value) {
+    for (int i = 0; i < 4; i++) p[i] = (Uint8)(value >> (i * 8));
+}
+
+static Uint32 get32(const Uint8 *p) {
+    return (Uint32)p[0] | (Uint32)p[1] << 8 | (Uint32)p[2] << 16 | (Uint32)p[3] << 24;
+}
+
+static int open_socket(int port, const char *peer) {
+    const char *colon = strrchr(peer, ':');
+    char host[256];
+    size_t len = colon ? (size_t)(colon - peer) : 0;
+    if (len == 0 || len >= sizeof(host)) {
+        printf("Netplay peer must be host:port, not %s\n", peer);
+        return 0;
+    }
+    memcpy(host, peer, len);
+    host[len] = '\0';
+
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        printf("Winsock failed to start\n");
+        return 0;
+    }
+#endif
+    struct addrinfo hints, *found;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    if (getaddrinfo(host, colon + 1, &hints, &found) != 0) {
+        printf("Netplay peer %s not found\n", peer);
+        return 0;
+    }
+    memcpy(&peer_addr, found->ai_addr, sizeof(peer_addr));
+    freeaddrinfo(found);
+
+    struct sockaddr_in local;
+    memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port = htons((Uint16)port);
+    sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock == INVALID_SOCKET || bind(sock, (struct sockaddr *)&local, sizeof(local)) != 0) {
+        printf("Netplay could not bind UDP port %d\n", port);
+        return 0;
+    }
+#ifdef _WIN32
+    u_long nonblocking = 1;
+    ioctlsocket(sock, FIONBIO, &nonblocking);
+#else
+    fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+#endif
+    return 1;
+}
+
+int net_init(int player, int port, const char *peer, Uint32 game_session, int lag_ms, const NetGame *net_game) {
+    game = net_game;
+    local_player = player;
+    session = game_session;
+    lag = lag_ms;
+    tick = 0;
+    memset(local_inputs, 0, sizeof(local_inputs));
+    memset(remote_inputs, 0, sizeof(remote_inputs));
+    local_known = remote_known = peer_ack = NET_INPUT_DELAY; // No input reaches the first ticks
+    rollback_to = -1;
+    hashed = peer_hash_tick = peer_hash_newest = -1;
+    connected = 0;
+    peer_tick = peer_lead = 0;
+    next_sync = SYNC_INTERVAL;
+    sync_wait = 0;
+    outbox_first = outbox_count = 0;
+    rollbacks = replayed = 0;
+    if (!open_socket(port, peer)) {
+        net_shutdown();
+        return 0;
+    }
+    printf("Netplay: player %d on port %d, waiting for %s\n", player + 1, port, peer);
+    return 1;
+}
+
+void net_shutdown(void) {
+    if (!game) return;
+    if (sock != INVALID_SOCKET) close_socket(sock);
+    sock = INVALID_SOCKET;
+#ifdef _WIN32
+    WSACleanup();
+#endif
+    game = NULL;
+}
+
+// Send every held-back packet that is due
+static void flush_outbox(void) {
+    Uint32 now = SDL_GetTicks();
+    while (outbox_count > 0 && (Sint32)(now - outbox[outbox_first].due) >= 0) {
+        sendto(sock, (const char *)outbox[outbox_first].data, outbox[outbox_first].size, 0,
+               (const struct sockaddr *)&peer_addr, sizeof(peer_addr));
+        outbox_first = (outbox_first + 1) % OUTBOX_SIZE;
+        outbox_count--;
+    }
+}
+
+// Run tick `tick` on the inputs known so far, guessing the peer's
+static void run_tick(int replaying) {
+    int i = tick & (INPUT_RING - 1);
+    game->save(tick & (NET_STATE_SLOTS - 1));
+    guessed[i] = tick < remote_known ? remote_inputs[i] : remote_inputs[(remote_known - 1) & (INPUT_RING - 1)];
+    Uint8 inputs[2];
+    inputs[local_player] = local_inputs[i];
+    inputs[!local_player] = guessed[i];
+    game->advance(inputs, replaying);
+    tick++;
+}
+
+static void receive(const Uint8 *p, int size) {
+    if (size < HEADER_SIZE || memcmp(p, MAGIC, sizeof(MAGIC)) != 0) return;
+    if (get32(p + 4) != session) {
+        if (!warned_session) printf("Netplay peer is playing a different game (seed or settings differ)\n");
+        warned_session = 1;
+        return;
+    }
+    int count = p[32];
+    if (size < HEADER_SIZE + count) return;
+    if (!connected) printf("Netplay: connected\n");
+    connected = 1;
+    last_heard = SDL_GetTicks();
+
+    int sender_tick = (int)get32(p + 8);
+    if (sender_tick > peer_tick) {
+        peer_tick = sender_tick;
+        peer_lead = (Sint32)get32(p + 12);
+    }
+    int ack = (int)get32(p + 16);
+    if (ack > peer_ack) peer_ack = ack;
+    if (get32(p + 20) != NO_HASH && (int)get32(p + 20) > peer_hash_newest) {
+        peer_hash_newest = peer_hash_tick = (int)get32(p + 20);
+        peer_hash = get32(p + 24);
+    }
+
+    // Inputs in order only; anything past a gap comes again
+    int first = (int)get32(p + 28);
+    for (int t = first; t < first + count && t <= remote_known; t++) {
+        if (t < remote_known) continue;
+        int i = t & (INPUT_RING - 1);
+        remote_inputs[i] = p[HEADER_SIZE + t - first];
+        if (t < tick && guessed[i] != remote_inputs[i] && rollback_to < 0) rollback_to = t;
+        remote_known++;
+    }
+}
+
+int net_poll(void) {
+    flush_outbox();
+    Uint8 packet[PACKET_SIZE];
+    int size;
+    while ((size = (int)recvfrom(sock, (char *)packet, sizeof(packet), 0, NULL, NULL)) > 0) receive(packet, size);
+    if (connected && SDL_GetTicks() - last_heard > TIMEOUT_MS) {
+        printf("Netplay peer stopped answering\n");
+        return 0;
+    }
+
+    // Run the ticks again from the first wrong guess, on the real inputs
+    if (rollback_to >= 0) {
+        int end = tick;
+        game->load(rollback_to & (NET_STATE_SLOTS - 1));
+        tick = rollback_to;
+        while (tick < end) run_tick(1);
+        rollbacks++;
+        replayed += end - rollback_to;
+        rollback_to = -1;
+    }
+
+    // Keep the sides level: both leads include the link's delay, so half
+    // their difference is how far this side really runs ahead
+    if (tick >= next_sync) {
+        int ahead = (tick - peer_tick - peer_lead) / 2;
+        if (ahead > 1) sync_wait = ahead < 8 ? ahead : 8;
+        next_sync = tick + SYNC_INTERVAL;
+    }
+
+    // Hash the states that are final now, and hold the peer's to ours
+    int last = remote_known < tick - 1 ? remote_known : tick - 1;
+    while (hashed < last) {
+        hashed++;
+        int slot = hashed & (NET_STATE_SLOTS - 1);
+        hashes[slot] = game->hash(slot);
+        hash_ticks[slot] = hashed;
+    }
+    if (peer_hash_tick >= 0 && peer_hash_tick <= hashed) {
+        int slot = peer_hash_tick & (NET_STATE_SLOTS - 1);
+        if (hash_ticks[slot] == peer_hash_tick && hashes[slot] != peer_hash) {
+            printf("Netplay desync at tick %d (hash %08x here, %08x on the peer)\n", peer_hash_tick, hashes[slot], peer_hash);
+            return 0;
+        }
+        peer_hash_tick = -1;
+    }
+    return 1;
+}
+
+int net_ready(void) {
+    if (!connected || tick - remote_known >= NET_MAX_ROLLBACK) return 0;
+    if (local_known - peer_ack >= INPUT_RING / 2) return 0; // Unacknowledged inputs must stay in the ring
+    if (sync_wait > 0) {
+        sync_wait--;
+        return 0;
+    }
+    return 1;
+}
+
+void net_advance(Uint8 input) {
+    local_inputs[local_known & (INPUT_RING - 1)] = input; // For tick + NET_INPUT_DELAY
+    local_known++;
+    run_tick(0);
+}
+
+void net_send(void) {
+    // A packet carries everything the last one did, so a newer one due in
+    // the same millisecond replaces it
+    Uint32 due = SDL_GetTicks() + (Uint32)lag;
+    int last = (outbox_first + outbox_count - 1) % OUTBOX_SIZE;
+    if (outbox_count == 0 || outbox[last].due != due) {
+        if (outbox_count == OUTBOX_SIZE) { // Out of room: lose the oldest
+            outbox_first = (outbox_first + 1) % OUTBOX_SIZE;
+            outbox_count--;
+        }
+        last = (outbox_first + outbox_count++) % OUTBOX_SIZE;
+    }
+
+    Uint8 *p = outbox[last].data;
+    int first = peer_ack;
+    int count = local_known - first < PACKET_INPUTS ? local_known - first : PACKET_INPUTS;
+    memcpy(p, MAGIC, sizeof(MAGIC));
+    put32(p + 4, session);
+    put32(p + 8, (Uint32)tick);
+    put32(p + 12, (Uint32)(tick - peer_tick));
+    put32(p + 16, (Uint32)remote_known);
+    put32(p + 20, hashed >= 0 ? (Uint32)hashed : NO_HASH);
+    put32(p + 24, hashed >= 0 ? hashes[hashed & (NET_STATE_SLOTS - 1)] : 0);
+    put32(p + 28, (Uint32)first);
+    p[32] = (Uint8)count;
+    for (int i = 0; i < count; i++) p[HEADER_SIZE + i] = local_inputs[(first + i) & (INPUT_RING - 1)];
+    outbox[last].size = HEADER_SIZE + count;
+    outbox[last].due = due;
+    flush_outbox();
+}
+
+int net_confirmed_slot(void) {
+    return hashed >= 0 ? hashed & (NET_STATE_SLOTS - 1) : -1;
+}
+
+void net_report(void) {
+    printf("Netplay: %d ticks, %d rollbacks, %d ticks run again, hash %08x at tick %d\n", tick, rollbacks, replayed,
+           hashed >= 0 ? hashes[hashed & (NET_STATE_SLOTS - 1)] : 0, hashed);
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#ifndef NETPLAY_H
+#define NETPLAY_H
+
+#include <SDL2/SDL.h>
+
+// Two-player rollback netplay over UDP: each player runs their own process
+// and only inputs cross the network. Ticks run straight away on a guess of
+// the peer's input (the last one received); when the real input turns out
+// different, the game loads the state saved before that tick and runs the
+// ticks again. Both sides hash every state whose inputs are all known and
+// compare hashes to catch a desync.
+#define NET_MAX_ROLLBACK 32 // Most ticks run past the peer's input (about 270 ms)
+#define NET_INPUT_DELAY 2   // Ticks before local input takes effect, so small lag never rolls back
+#define NET_STATE_SLOTS 64  // States the game keeps (power of two, more than NET_MAX_ROLLBACK + 1)
+
+// The game under netplay, which keeps NET_STATE_SLOTS saved states
+typedef struct {
+    void (*save)(int slot);
+    void (*load)(int slot);
+    Uint32 (*hash)(int slot);
+    // Run one tick with both players' inputs (bits the game defines). Ticks
+    // run again after a rollback are `replaying` (no sounds)
+    void (*advance)(const Uint8 inputs[2], int replaying);
+} NetGame;
+
+// Bind UDP `port` and play as player 0 or 1 against `peer` ("host:port").
+// Both sides must pass the same `session` (a hash of the game's seed and
+// settings). `lag_ms` holds every outgoing packet back, to try out a slow link
+int net_init(int player, int port, const char *peer, Uint32 session, int lag_ms, const NetGame *game);
+void net_shutdown(void);
+
+// Take in the peer's packets and roll back over mispredicted ticks; returns
+// 0 on a desync or once the peer has gone quiet
+int net_poll(void);
+// 1 if another tick can run: the peer has answered and isn't too far behind
+int net_ready(void);
+// Run one tick with this player's input
+void net_advance(Uint8 input);
+// Send the peer every input it hasn't acknowledged
+void net_send(void);
+// Slot of the newest state whose inputs are all known, -1 before there is one
+int net_confirmed_slot(void);
+// Print ticks run, rollbacks and the newest confirmed hash
+void net_report(void);
+
+#endif // NETPLAY_H
\ No newline at end of file
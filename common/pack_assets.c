@@ -0,0 +1,117 @@
+#include <SDL2/SDL.h>
+#include "audio.h"
+#include "pak.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Build step: decode WAV files into the mixer's format and pack them into
+// one archive the game maps at startup. Usage: pack_assets OUT.pak FILE.wav...
+// Entries are named after the file (without directories).
+
+typedef struct {
+    float *samples;
+    Uint32 size;
+    Uint32 offset;
+    int same_as; // Index of an earlier identical blob, or -1
+} Blob;
+
+static const char *base_name(const char *path) {
+    const char *name = path;
+    for (const char *p = path; *p; p++) {
+        if (*p == '/' || *p == '\\') name = p + 1;
+    }
+    return name;
+}
+
+static Uint32 align_up(Uint32 n) {
+    return (n + PAK_ALIGN - 1) & ~(Uint32)(PAK_ALIGN - 1);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        printf("Usage: %s OUT.pak FILE.wav...\n", argv[0]);
+        return 1;
+    }
+    int count = argc - 2;
+    PakEntry *entries = calloc(count, sizeof(PakEntry));
+    Blob *blobs = calloc(count, sizeof(Blob));
+    if (!entries || !blobs) {
+        printf("Out of memory\n");
+        return 1;
+    }
+
+    Uint32 offset = align_up(sizeof(PakHeader) + count * sizeof(PakEntry));
+    int failed = 0;
+    for (int i = 0; i < count && !failed; i++) {
+        const char *path = argv[i + 2];
+        const char *name = base_name(path);
+        if (strlen(name) >= PAK_NAME_LEN) {
+            printf("%s: name longer than %d characters\n", path, PAK_NAME_LEN - 1);
+            failed = 1;
+            break;
+        }
+        for (int j = 0; j < i; j++) {
+            if (strcmp(entries[j].name, name) == 0) {
+                printf("%s: %s is already packed\n", path, name);
+                failed = 1;
+            }
+        }
+        if (failed) break;
+        int frames;
+        blobs[i].samples = audio_decode_wav(path, &frames);
+        if (!blobs[i].samples) {
+            printf("%s: %s\n", path, SDL_GetError());
+            failed = 1;
+            break;
+        }
+        blobs[i].size = (Uint32)frames * 2 * sizeof(float);
+        strcpy(entries[i].name, name);
+        entries[i].size = blobs[i].size;
+
+        // The same sound under another name shares the earlier copy
+        blobs[i].same_as = -1;
+        for (int j = 0; j < i && blobs[i].same_as < 0; j++) {
+            if (blobs[j].same_as < 0 && blobs[j].size == blobs[i].size &&
+                memcmp(blobs[j].samples, blobs[i].samples, blobs[i].size) == 0) {
+                blobs[i].same_as = j;
+            }
+        }
+        if (blobs[i].same_as >= 0) {
+            entries[i].offset = blobs[blobs[i].same_as].offset;
+        } else {
+            entries[i].offset = blobs[i].offset = offset;
+            offset = align_up(offset + blobs[i].size);
+        }
+    }
+
+    FILE *file = failed ? NULL : fopen(argv[1], "wb");
+    if (!failed && !file) {
+        printf("Can't write %s\n", argv[1]);
+        failed = 1;
+    }
+    if (file) {
+        PakHeader header = {.version = PAK_VERSION, .count = (Uint32)count};
+        memcpy(header.magic, PAK_MAGIC, sizeof(header.magic));
+        static const Uint8 zeros[PAK_ALIGN];
+        long written = sizeof(header) + count * sizeof(PakEntry);
+        fwrite(&header, sizeof(header), 1, file);
+        fwrite(entries, sizeof(PakEntry), count, file);
+        for (int i = 0; i < count; i++) {
+            if (blobs[i].same_as >= 0) continue;
+            fwrite(zeros, 1, blobs[i].offset - written, file); // Padding
+            fwrite(blobs[i].samples, 1, blobs[i].size, file);
+            written = blobs[i].offset + blobs[i].size;
+        }
+        if (fclose(file) != 0) {
+            printf("Can't write %s\n", argv[1]);
+            failed = 1;
+        }
+    }
+    if (failed) remove(argv[1]);
+
+    for (int i = 0; i < count; i++) free(blobs[i].samples);
+    free(blobs);
+    free(entries);
+    return failed;
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#ifndef PAK_H
+#define PAK_H
+
+#include <SDL2/SDL.h>
+
+// Asset archive layout, shared by pack_assets and the runtime loader.
+// All fields are in host byte order; archives are built next to the game
+// by the build and never shipped between machines.
+//
+//   PakHeader
+//   PakEntry[count]
+//   data, each blob PAK_ALIGN aligned (identical blobs are stored once)
+#define PAK_MAGIC "FPAK"
+#define PAK_VERSION 1
+#define PAK_NAME_LEN 32
+#define PAK_ALIGN 64
+
+typedef struct {
+    char magic[4];
+    Uint32 version;
+    Uint32 count;
+    Uint32 reserved;
+} PakHeader;
+
+// A sound: interleaved float stereo at AUDIO_FREQ, size / 8 frames
+typedef struct {
+    char name[PAK_NAME_LEN]; // NUL terminated
+    Uint32 offset;           // From the start of the archive
+    Uint32 size;             // In bytes
+    Uint32 reserved[2];
+} PakEntry;
+
+#endif // PAK_H
\ No newline at end of file
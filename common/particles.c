@@ -0,0 +1,213 @@
+#include "particles.h"
+#include "blit.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PARTICLES_X86 1
+#endif
+
+// Capacity is rounded up to whole vectors, so integration never needs a
+// scalar tail: lanes past the count are spare particles, zeroed at creation
+#define PARTICLE_LANES 8
+
+// Move particles [0, n) on one tick: velocity first, then position (as the
+// games' bodies do), and burn their life
+typedef void (*IntegrateFn)(Particles *particles, int n, float dt);
+
+static void integrate_scalar(Particles *particles, int n, float dt) {
+    float fall = particles->gravity * dt;
+    for (int i = 0; i < n; i++) {
+        particles->vel_y[i] += fall;
+        particles->x[i] += particles->vel_x[i] * dt;
+        particles->y[i] += particles->vel_y[i] * dt;
+        particles->life[i] -= dt;
+    }
+}
+
+#ifdef PARTICLES_X86
+__attribute__((target("sse2")))
+static void integrate_sse2(Particles *particles, int n, float dt) {
+    const __m128 step = _mm_set1_ps(dt), fall = _mm_set1_ps(particles->gravity * dt);
+    for (int i = 0; i < n; i += 4) {
+        __m128 vel_y = _mm_add_ps(_mm_loadu_ps(particles->vel_y + i), fall);
+        _mm_storeu_ps(particles->vel_y + i, vel_y);
+        __m128 x = _mm_add_ps(_mm_loadu_ps(particles->x + i), _mm_mul_ps(_mm_loadu_ps(particles->vel_x + i), step));
+        _mm_storeu_ps(particles->x + i, x);
+        _mm_storeu_ps(particles->y + i, _mm_add_ps(_mm_loadu_ps(particles->y + i), _mm_mul_ps(vel_y, step)));
+        _mm_storeu_ps(particles->life + i, _mm_sub_ps(_mm_loadu_ps(particles->life + i), step));
+    }
+}
+
+__attribute__((target("avx2")))
+static void integrate_avx2(Particles *particles, int n, float dt) {
+    const __m256 step = _mm256_set1_ps(dt), fall = _mm256_set1_ps(particles->gravity * dt);
+    for (int i = 0; i < n; i += 8) {
+        __m256 vel_y = _mm256_add_ps(_mm256_loadu_ps(particles->vel_y + i), fall);
+        _mm256_storeu_ps(particles->vel_y + i, vel_y);
+        __m256 x = _mm256_add_ps(_mm256_loadu_ps(particles->x + i), _mm256_mul_ps(_mm256_loadu_ps(particles->vel_x + i), step));
+        _mm256_storeu_ps(particles->x + i, x);
+        _mm256_storeu_ps(particles->y + i, _mm256_add_ps(_mm256_loadu_ps(particles->y + i), _mm256_mul_ps(vel_y, step)));
+        _mm256_storeu_ps(particles->life + i, _mm256_sub_ps(_mm256_loadu_ps(particles->life + i), step));
+    }
+}
+#endif
+
+static IntegrateFn integrate;
+
+static IntegrateFn pick_integrate(void) {
+#ifdef PARTICLES_X86
+    if (SDL_HasAVX2()) return integrate_avx2;
+    if (SDL_HasSSE2()) return integrate_sse2;
+#endif
+    return integrate_scalar;
+}
+
+Particles *particles_create(int capacity, float gravity) {
+    if (capacity < 1) capacity = 1;
+    capacity = (capacity + PARTICLE_LANES - 1) / PARTICLE_LANES * PARTICLE_LANES;
+    Particles *particles = calloc(1, sizeof(Particles));
+    if (!particles) {
+        printf("Particle pool allocation failed\n");
+        return NULL;
+    }
+    particles->capacity = capacity;
+    particles->gravity = gravity;
+
+    // One block holding every field
+    size_t n = (size_t)capacity;
+    char *block = calloc(n, 5 * sizeof(float) + sizeof(Uint32) + 2 * (2 * sizeof(int) + sizeof(Uint32)));
+    if (!block) {
+        printf("Particle pool allocation failed (%d particles)\n", capacity);
+        free(particles);
+        return NULL;
+    }
+    particles->x = (float *)block;
+    particles->y = particles->x + n;
+    particles->vel_x = particles->y + n;
+    particles->vel_y = particles->vel_x + n;
+    particles->life = particles->vel_y + n;
+    particles->color = (Uint32 *)(particles->life + n);
+    particles->screen_x = (int *)(particles->color + n);
+    particles->screen_y = particles->screen_x + n;
+    particles->screen_color = (Uint32 *)(particles->screen_y + n);
+    particles->spare_x = (int *)(particles->screen_color + n);
+    particles->spare_y = particles->spare_x + n;
+    particles->spare_color = (Uint32 *)(particles->spare_y + n);
+    return particles;
+}
+
+void particles_destroy(Particles *particles) {
+    if (!particles) return;
+    free(particles->x); // The block's start
+    free(particles);
+}
+
+void particles_clear(Particles *particles) {
+    particles->count = 0;
+    particles->screen_count = 0;
+}
+
+int particles_spawn(Particles *particles, float x, float y, float vel_x, float vel_y, float life, Uint32 color) {
+    if (particles->count == particles->capacity) return 0;
+    int i = particles->count++;
+    particles->x[i] = x;
+    particles->y[i] = y;
+    particles->vel_x[i] = vel_x;
+    particles->vel_y[i] = vel_y;
+    particles->life[i] = life;
+    particles->color[i] = color;
+    return 1;
+}
+
+// Evenly in [lo, hi]
+static float rng_between(Rng *rng, float lo, float hi) {
+    return lo + (hi - lo) * (float)(rng_next(rng) >> 8) * (1.0f / 16777216.0f);
+}
+
+int particles_emit(Particles *particles, const ParticleEmitter *emitter, Rng *rng, int count,
+                   float x, float y, float vel_x, float vel_y) {
+    int spawned = 0;
+    for (; spawned < count; spawned++) {
+        float angle = emitter->angle + rng_between(rng, -emitter->spread, emitter->spread);
+        float speed = rng_between(rng, emitter->min_speed, emitter->max_speed);
+        float life = rng_between(rng, emitter->min_life, emitter->max_life);
+        Uint32 color = emitter->colors[rng_range(rng, emitter->color_count)];
+        if (!particles_spawn(particles, x, y, vel_x + sinf(angle) * speed, vel_y - cosf(angle) * speed, life, color)) break;
+    }
+    return spawned;
+}
+
+void particles_update(Particles *particles, float dt) {
+    if (!integrate) integrate = pick_integrate();
+    int n = (particles->count + PARTICLE_LANES - 1) / PARTICLE_LANES * PARTICLE_LANES;
+    integrate(particles, n, dt);
+
+    // Swap the last particle into each dead one's place (and look at it again)
+    for (int i = 0; i < particles->count;) {
+        if (particles->life[i] > 0.0f) {
+            i++;
+            continue;
+        }
+        int last = --particles->count;
+        particles->x[i] = particles->x[last];
+        particles->y[i] = particles->y[last];
+        particles->vel_x[i] = particles->vel_x[last];
+        particles->vel_y[i] = particles->vel_y[last];
+        particles->life[i] = particles->life[last];
+        particles->color[i] = particles->color[last];
+    }
+}
+
+SDL_Rect particles_render(Particles *particles, Frame *frame, const ParticleView *view) {
+    // The last render's points may still be waiting to be erased this frame
+    int *swap_x = particles->screen_x, *swap_y = particles->screen_y;
+    Uint32 *swap_color = particles->screen_color;
+    particles->screen_x = particles->spare_x;
+    particles->screen_y = particles->spare_y;
+    particles->screen_color = particles->spare_color;
+    particles->spare_x = swap_x;
+    particles->spare_y = swap_y;
+    particles->spare_color = swap_color;
+
+    // Project, keeping the particles that land on the frame
+    float right = (float)(frame->width - 1), bottom = (float)(frame->height - 1);
+    int count = 0;
+    int left = frame->width, top = frame->height, last_x = -1, last_y = -1;
+    for (int i = 0; i < particles->count; i++) {
+        float sx = (particles->x[i] + particles->vel_x[i] * view->ahead - view->origin_x) * view->scale;
+        float sy = (particles->y[i] + particles->vel_y[i] * view->ahead - view->origin_y) * view->scale;
+        if (!(sx >= 0.0f && sx <= right && sy >= 0.0f && sy <= bottom)) continue; // Also drops NaNs
+        int px = (int)sx, py = (int)sy;
+        particles->screen_x[count] = px;
+        particles->screen_y[count] = py;
+        particles->screen_color[count] = particles->color[i];
+        count++;
+        if (px < left) left = px;
+        if (px > last_x) last_x = px;
+        if (py < top) top = py;
+        if (py > last_y) last_y = py;
+    }
+    particles->screen_count = count;
+    particles->screen_size = view->size;
+    SDL_Rect drawn = {0, 0, 0, 0};
+    if (count == 0) return drawn;
+
+    draw_points(0, 0, particles->screen_x, particles->screen_y, particles->screen_color, count, view->size, frame);
+    drawn.x = left;
+    drawn.y = top;
+    drawn.w = last_x - left + view->size;
+    drawn.h = last_y - top + view->size;
+    return drawn;
+}
+
+void particles_erase(Particles *particles, Frame *frame, ParticleUnderFn under, const void *data) {
+    // The last frame is done with the colors, so they can hold what goes back
+    for (int i = 0; i < particles->screen_count; i++) {
+        particles->screen_color[i] = under(data, particles->screen_x[i], particles->screen_y[i]);
+    }
+    draw_points(0, 0, particles->screen_x, particles->screen_y, particles->screen_color, particles->screen_count, 1, frame);
+    particles->screen_count = 0;
+}
\ No newline at end of file
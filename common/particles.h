@@ -0,0 +1,75 @@
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include <SDL2/SDL.h>
+#include "frame.h"
+#include "rng.h"
+
+// Particle pool for effects (exhaust, debris, sparks). Capacity is fixed
+// and every array is allocated by particles_create, one array per field so
+// integration runs over whole vectors of particles. Spawning appends, and a
+// particle that runs out of life is replaced by the last one, both O(1).
+// Particles are only drawn, never simulated, so they stay out of saved
+// states and replays
+typedef struct {
+    int capacity, count;
+    float gravity;                // px/s^2, down
+    float *x, *y, *vel_x, *vel_y; // Position in whatever space the game spawns them in, and px/s
+    float *life;                  // Seconds left
+    Uint32 *color;
+    int *screen_x, *screen_y;     // On-screen particles as of the last render
+    Uint32 *screen_color;
+    int screen_count;
+    int screen_size;
+    // The same for the render before, so a frame can erase the last
+    // particles and draw the new ones before either is rasterized
+    int *spare_x, *spare_y;
+    Uint32 *spare_color;
+} Particles;
+
+// What's under a screen pixel once the particles are gone
+typedef Uint32 (*ParticleUnderFn)(const void *data, int x, int y);
+
+// A spray of particles: directions within `spread` radians either side of
+// `angle` (clockwise from up), speeds and lives picked evenly in their
+// ranges, colors picked from `colors`
+typedef struct {
+    float angle, spread;
+    float min_speed, max_speed; // px/s
+    float min_life, max_life;   // Seconds
+    const Uint32 *colors;
+    int color_count;
+} ParticleEmitter;
+
+// How particles land on screen: at (position + velocity * ahead - origin)
+// * scale, as size x size squares (1 for single pixels). A negative
+// `ahead` draws them back where the simulation's blended position is
+typedef struct {
+    float origin_x, origin_y;
+    float scale;
+    float ahead; // Seconds
+    int size;
+} ParticleView;
+
+// Make a pool for `capacity` particles; returns NULL on failure
+Particles *particles_create(int capacity, float gravity);
+void particles_destroy(Particles *particles);
+// Drop every particle
+void particles_clear(Particles *particles);
+// Add one; returns 0 (and drops it) when the pool is full
+int particles_spawn(Particles *particles, float x, float y, float vel_x, float vel_y, float life, Uint32 color);
+// Spray `count` from (x, y), adding (vel_x, vel_y) to each one's velocity
+// (the emitter's own); returns how many fit
+int particles_emit(Particles *particles, const ParticleEmitter *emitter, Rng *rng, int count,
+                   float x, float y, float vel_x, float vel_y);
+// Advance every particle `dt` seconds and drop those out of life
+void particles_update(Particles *particles, float dt);
+// Draw every particle on screen, returning the rectangle they cover (empty
+// if none showed) so they can be erased next frame. The pool must not change
+// until end_frame
+SDL_Rect particles_render(Particles *particles, Frame *frame, const ParticleView *view);
+// Erase the particles as last drawn one pixel at a time, for backgrounds
+// that are costly to restore by the rectangle (1 pixel particles only)
+void particles_erase(Particles *particles, Frame *frame, ParticleUnderFn under, const void *data);
+
+#endif // PARTICLES_H
\ No newline at end of file
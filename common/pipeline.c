@@ -0,0 +1,52 @@
+#include "pipeline.h"
+#include <stdio.h>
+
+static SDL_Thread *thread;
+static SDL_sem *start, *done;
+static SDL_atomic_t quit;
+static PipelineFn simulate;
+static void *simulate_data;
+
+static int SDLCALL simulation_main(void *data) {
+    for (;;) {
+        SDL_SemWait(start);
+        if (SDL_AtomicGet(&quit)) return 0;
+        simulate(simulate_data);
+        SDL_SemPost(done); // Also publishes everything the frame wrote
+    }
+}
+
+int pipeline_init(PipelineFn fn, void *data) {
+    simulate = fn;
+    simulate_data = data;
+    SDL_AtomicSet(&quit, 0);
+    start = SDL_CreateSemaphore(0);
+    done = SDL_CreateSemaphore(0);
+    thread = start && done ? SDL_CreateThread(simulation_main, "simulation", NULL) : NULL;
+    if (!thread) {
+        printf("Simulation thread failed to start: %s\n", SDL_GetError());
+        pipeline_shutdown();
+        return 0;
+    }
+    return 1;
+}
+
+void pipeline_shutdown(void) {
+    if (thread) {
+        SDL_AtomicSet(&quit, 1);
+        SDL_SemPost(start);
+        SDL_WaitThread(thread, NULL);
+        thread = NULL;
+    }
+    if (start) SDL_DestroySemaphore(start);
+    if (done) SDL_DestroySemaphore(done);
+    start = done = NULL;
+}
+
+void pipeline_start(void) {
+    SDL_SemPost(start);
+}
+
+void pipeline_wait(void) {
+    SDL_SemWait(done);
+}
\ No newline at end of file
@@ -0,0 +1,22 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <SDL2/SDL.h>
+
+// Pipelined frames (--pipeline): the simulation of the next frame runs on
+// its own thread while the caller draws and presents the current one from
+// an immutable snapshot. Everything the simulation touches (input, audio,
+// game state) belongs to it between pipeline_start and pipeline_wait, and
+// to the caller otherwise
+typedef void (*PipelineFn)(void *data);
+
+// Start the simulation thread, which runs `simulate(data)` once per pipeline_start
+int pipeline_init(PipelineFn simulate, void *data);
+void pipeline_shutdown(void);
+
+// Simulate one frame in the background
+void pipeline_start(void);
+// Wait for that frame's simulation to finish
+void pipeline_wait(void);
+
+#endif // PIPELINE_H
\ No newline at end of file
@@ -0,0 +1,362 @@
+#include "raster.h"
+#include "blit.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef enum {
+    CMD_FILL,    // fill_rect
+    CMD_COLUMNS, // fill_columns
+    CMD_SHIFT,   // shift_rows_left
+    CMD_SPRITE,  // draw_sprite, or draw_sprite_scaled when scale > 0
+    CMD_IMAGE,   // draw_image
+    CMD_COPY,    // copy_rect
+    CMD_POINTS   // draw_points
+} CmdType;
+
+// One recorded drawing call, in frame coordinates
+typedef struct {
+    CmdType type;
+    int x, y, w, h;
+    Uint32 color;
+    int scale;           // Sprites: 0 unscaled; shifts: pixels moved left; points: their size
+    const Uint8 *sprite;
+    const Uint32 *pixels, *mask;
+    int top, bottom;     // Columns: offsets into spans, or -1 for the rect's edge
+                         // Points: top is where they start in `points` (w of them, over h bands)
+    const Frame *layer;  // Copies: the source
+} RasterCmd;
+
+// Indexes of the commands touching one band, in recording order
+typedef struct {
+    int *items;
+    int count, capacity;
+} Bin;
+
+static RasterCmd *cmds;
+static int cmd_count, cmd_capacity;
+static int *spans; // Column bounds copied out of fill_columns calls
+static int span_count, span_capacity;
+// Points copied out of draw_points calls, sorted by band. Each call adds a
+// table of where every band's points start (bands + 1 entries), then its
+// points' x, y and color, each grouped by band
+static int *points;
+static int point_count, point_capacity;
+static int *point_cursors; // Scratch for sorting, one per band
+static int cursor_capacity;
+static Bin *bins;
+static int bin_count;
+
+// Pool: workers wait on `start`, take bands until none are left and post `done`
+static SDL_Thread *workers[RASTER_MAX_THREADS];
+static int worker_count;
+static SDL_sem *start, *done;
+static SDL_atomic_t next_band;
+static SDL_atomic_t quit;
+static Frame *target; // Frame being rasterized
+static int band_total;
+
+// Grow an array to hold `needed` items; 0 if out of memory
+static int reserve(void **items, int *capacity, int needed, size_t size) {
+    if (needed <= *capacity) return 1;
+    int grown = *capacity ? *capacity * 2 : 64;
+    if (grown < needed) grown = needed;
+    void *p = realloc(*items, (size_t)grown * size);
+    if (!p) return 0;
+    *items = p;
+    *capacity = grown;
+    return 1;
+}
+
+// Bin a command for the rows [y, y + h) it can touch. All growth happens
+// before anything is added, so a failed push leaves no trace
+static int push(Frame *frame, const RasterCmd *cmd, int y, int h) {
+    int bands = (frame->height + RASTER_BAND_HEIGHT - 1) / RASTER_BAND_HEIGHT;
+    if (bands > bin_count) {
+        Bin *grown = realloc(bins, bands * sizeof(Bin));
+        if (!grown) {
+            raster_flush(frame);
+            return 0;
+        }
+        memset(grown + bin_count, 0, (bands - bin_count) * sizeof(Bin));
+        bins = grown;
+        bin_count = bands;
+    }
+    int y0 = y < 0 ? 0 : y;
+    int y1 = y + h > frame->height ? frame->height : y + h;
+    if (y0 >= y1) return 1; // Nothing on screen
+    int first = y0 / RASTER_BAND_HEIGHT;
+    int last = (y1 - 1) / RASTER_BAND_HEIGHT;
+
+    int ok = reserve((void **)&cmds, &cmd_capacity, cmd_count + 1, sizeof(RasterCmd));
+    for (int b = first; ok && b <= last; b++) {
+        ok = reserve((void **)&bins[b].items, &bins[b].capacity, bins[b].count + 1, sizeof(int));
+    }
+    if (!ok) {
+        raster_flush(frame);
+        return 0;
+    }
+    for (int b = first; b <= last; b++) bins[b].items[bins[b].count++] = cmd_count;
+    cmds[cmd_count++] = *cmd;
+    return 1;
+}
+
+int raster_push_fill(Frame *frame, int x, int y, int w, int h, Uint32 color) {
+    RasterCmd cmd = {.type = CMD_FILL, .x = x, .y = y, .w = w, .h = h, .color = color};
+    return push(frame, &cmd, y, h);
+}
+
+int raster_push_columns(Frame *frame, int x, int y, int w, int h, const int *top, const int *bottom, Uint32 color) {
+    RasterCmd cmd = {.type = CMD_COLUMNS, .x = x, .y = y, .w = w, .h = h, .color = color, .top = -1, .bottom = -1};
+    int needed = span_count + (top ? w : 0) + (bottom ? w : 0);
+    if (!reserve((void **)&spans, &span_capacity, needed, sizeof(int))) {
+        raster_flush(frame);
+        return 0;
+    }
+    if (top) {
+        cmd.top = span_count;
+        memcpy(spans + span_count, top, w * sizeof(int));
+        span_count += w;
+    }
+    if (bottom) {
+        cmd.bottom = span_count;
+        memcpy(spans + span_count, bottom, w * sizeof(int));
+        span_count += w;
+    }
+    return push(frame, &cmd, y, h); // A failed push rasterizes and clears everything, copies included
+}
+
+int raster_push_shift(Frame *frame, int y, int h, int dx) {
+    RasterCmd cmd = {.type = CMD_SHIFT, .y = y, .h = h, .scale = dx};
+    return push(frame, &cmd, y, h);
+}
+
+int raster_push_sprite(Frame *frame, int x, int y, const Uint8 *sprite, int width, int height, int scale, Uint32 color) {
+    RasterCmd cmd = {.type = CMD_SPRITE, .x = x, .y = y, .w = width, .h = height,
+                     .color = color, .scale = scale, .sprite = sprite};
+    return push(frame, &cmd, y, scale ? height * scale : height);
+}
+
+int raster_push_image(Frame *frame, int x, int y, const Uint32 *pixels, const Uint32 *mask, int width, int height) {
+    RasterCmd cmd = {.type = CMD_IMAGE, .x = x, .y = y, .w = width, .h = height, .pixels = pixels, .mask = mask};
+    return push(frame, &cmd, y, height);
+}
+
+int raster_push_copy(Frame *frame, const Frame *layer, int x, int y, int w, int h) {
+    RasterCmd cmd = {.type = CMD_COPY, .x = x, .y = y, .w = w, .h = h, .layer = layer};
+    return push(frame, &cmd, y, h);
+}
+
+// Bands of the rows [top, bottom) clipped to the frame, or 0 if none of
+// them are on it
+static int point_bands(const Frame *frame, int top, int bottom, int *first, int *last) {
+    if (top >= frame->height || bottom <= 0) return 0;
+    *first = top < 0 ? 0 : top / RASTER_BAND_HEIGHT;
+    *last = ((bottom > frame->height ? frame->height : bottom) - 1) / RASTER_BAND_HEIGHT;
+    return 1;
+}
+
+// Copy the points out sorted by band (a counting sort, so each band keeps
+// their order), so a band replays only the points on its rows. Points
+// straddling bands go in each of them
+int raster_push_points(Frame *frame, int x, int y, const int *xs, const int *ys, const Uint32 *colors,
+                       int count, int size) {
+    int bands = (frame->height + RASTER_BAND_HEIGHT - 1) / RASTER_BAND_HEIGHT;
+    int most_bands = (size + RASTER_BAND_HEIGHT - 2) / RASTER_BAND_HEIGHT + 1; // A point can touch
+    if ((size_t)count * most_bands * 3 + bands + 1 > (size_t)INT_MAX - point_count ||
+        !reserve((void **)&points, &point_capacity, point_count + count * most_bands * 3 + bands + 1, sizeof(int)) ||
+        !reserve((void **)&point_cursors, &cursor_capacity, bands, sizeof(int))) {
+        raster_flush(frame);
+        return 0;
+    }
+
+    // Count the points on each band's rows, then where each band's start
+    int *starts = points + point_count;
+    memset(starts, 0, (bands + 1) * sizeof(int));
+    int first_band = bands, last_band = -1;
+    for (int i = 0; i < count; i++) {
+        int px = x + xs[i], py = y + ys[i];
+        int first, last;
+        if (px >= frame->width || px + size <= 0 || !point_bands(frame, py, py + size, &first, &last)) continue;
+        for (int b = first; b <= last; b++) starts[b + 1]++;
+        if (first < first_band) first_band = first;
+        if (last > last_band) last_band = last;
+    }
+    if (last_band < 0) return 1; // Nothing on screen
+    for (int b = 0; b < bands; b++) {
+        point_cursors[b] = starts[b];
+        starts[b + 1] += starts[b];
+    }
+
+    int total = starts[bands];
+    int *sorted_xs = starts + bands + 1;
+    int *sorted_ys = sorted_xs + total;
+    Uint32 *sorted_colors = (Uint32 *)(sorted_ys + total);
+    for (int i = 0; i < count; i++) {
+        int px = x + xs[i], py = y + ys[i];
+        int first, last;
+        if (px >= frame->width || px + size <= 0 || !point_bands(frame, py, py + size, &first, &last)) continue;
+        for (int b = first; b <= last; b++) {
+            int k = point_cursors[b]++;
+            sorted_xs[k] = xs[i];
+            sorted_ys[k] = ys[i];
+            sorted_colors[k] = colors[i];
+        }
+    }
+
+    RasterCmd cmd = {.type = CMD_POINTS, .x = x, .y = y, .w = total, .h = bands, .scale = size, .top = point_count};
+    point_count += bands + 1 + 3 * total;
+    int top = first_band * RASTER_BAND_HEIGHT;
+    return push(frame, &cmd, top, (last_band + 1) * RASTER_BAND_HEIGHT - top); // A failed push clears the copies too
+}
+
+// Replay one command into a band whose first row is frame row y0
+static void run_command(const RasterCmd *cmd, Frame *band, int y0) {
+    int y = cmd->y - y0;
+    switch (cmd->type) {
+    case CMD_FILL:
+        fill_rect(band, cmd->x, y, cmd->w, cmd->h, cmd->color);
+        break;
+    case CMD_COLUMNS: {
+        // Bounds are frame rows; move them into the band's, a piece at a time
+        int top[256], bottom[256];
+        for (int i = 0; i < cmd->w; i += 256) {
+            int n = cmd->w - i < 256 ? cmd->w - i : 256;
+            for (int j = 0; j < n; j++) {
+                top[j] = cmd->top >= 0 ? spans[cmd->top + i + j] - y0 : y;
+                bottom[j] = cmd->bottom >= 0 ? spans[cmd->bottom + i + j] - y0 : y + cmd->h;
+            }
+            fill_columns(band, cmd->x + i, y, n, cmd->h, top, bottom, cmd->color);
+        }
+        break;
+    }
+    case CMD_SHIFT:
+        shift_rows_left(band, y, cmd->h, cmd->scale);
+        break;
+    case CMD_SPRITE:
+        if (cmd->scale) {
+            draw_sprite_scaled(cmd->x, y, cmd->sprite, cmd->w, cmd->h, cmd->scale, cmd->color, band);
+        } else {
+            draw_sprite(cmd->x, y, cmd->sprite, cmd->w, cmd->h, cmd->color, band);
+        }
+        break;
+    case CMD_IMAGE:
+        draw_image(cmd->x, y, cmd->pixels, cmd->mask, cmd->w, cmd->h, band);
+        break;
+    case CMD_COPY: {
+        // The layer's rows from the band's first, lined up with the band
+        Frame layer = *cmd->layer;
+        layer.pixels += y0 * layer.pitch;
+        layer.height -= y0;
+        copy_rect(band, &layer, cmd->x, y, cmd->w, cmd->h);
+        break;
+    }
+    case CMD_POINTS: {
+        // This band's share of the sorted points
+        const int *starts = points + cmd->top;
+        const int *xs = starts + cmd->h + 1;
+        const int *ys = xs + cmd->w;
+        const Uint32 *colors = (const Uint32 *)(ys + cmd->w);
+        int b = y0 / RASTER_BAND_HEIGHT;
+        int first = starts[b];
+        draw_points(cmd->x, y, xs + first, ys + first, colors + first, starts[b + 1] - first, cmd->scale, band);
+        break;
+    }
+    }
+}
+
+// Take bands until there are none left. A band is the target's rows seen
+// as a frame of their own, so the primitives clip to it
+static void rasterize_bands(void) {
+    int band_index;
+    while ((band_index = SDL_AtomicAdd(&next_band, 1)) < band_total) {
+        const Bin *bin = &bins[band_index];
+        if (bin->count == 0) continue;
+        int y0 = band_index * RASTER_BAND_HEIGHT;
+        Frame band = *target;
+        band.pixels += y0 * target->pitch;
+        band.height = target->height - y0 < RASTER_BAND_HEIGHT ? target->height - y0 : RASTER_BAND_HEIGHT;
+        band.deferred = 0;
+        band.dirty_full = 1; // Recording marked the target already
+        for (int i = 0; i < bin->count; i++) run_command(&cmds[bin->items[i]], &band, y0);
+    }
+}
+
+static int SDLCALL worker_main(void *data) {
+    for (;;) {
+        SDL_SemWait(start);
+        if (SDL_AtomicGet(&quit)) return 0;
+        rasterize_bands();
+        SDL_SemPost(done);
+    }
+}
+
+int raster_init(int threads) {
+    if (threads < 1 || threads > RASTER_MAX_THREADS) {
+        printf("Rasterizer threads must be 1 to %d\n", RASTER_MAX_THREADS);
+        return 0;
+    }
+    if (threads == 1) return 1;
+    start = SDL_CreateSemaphore(0);
+    done = SDL_CreateSemaphore(0);
+    SDL_AtomicSet(&quit, 0);
+    for (int i = 0; start && done && i < threads - 1; i++) {
+        workers[worker_count] = SDL_CreateThread(worker_main, "raster", NULL);
+        if (!workers[worker_count]) break;
+        worker_count++;
+    }
+    if (worker_count < threads - 1) {
+        printf("Rasterizer threads failed to start: %s\n", SDL_GetError());
+        raster_shutdown();
+        return 0;
+    }
+    return 1;
+}
+
+void raster_shutdown(void) {
+    SDL_AtomicSet(&quit, 1);
+    for (int i = 0; i < worker_count; i++) SDL_SemPost(start);
+    for (int i = 0; i < worker_count; i++) SDL_WaitThread(workers[i], NULL);
+    worker_count = 0;
+    if (start) SDL_DestroySemaphore(start);
+    if (done) SDL_DestroySemaphore(done);
+    start = done = NULL;
+
+    for (int b = 0; b < bin_count; b++) free(bins[b].items);
+    free(bins);
+    free(cmds);
+    free(spans);
+    free(points);
+    free(point_cursors);
+    bins = NULL;
+    cmds = NULL;
+    spans = NULL;
+    points = point_cursors = NULL;
+    bin_count = cmd_count = cmd_capacity = span_count = span_capacity = 0;
+    point_count = point_capacity = cursor_capacity = 0;
+}
+
+int raster_threads(void) {
+    return worker_count + 1;
+}
+
+void raster_flush(Frame *frame) {
+    if (cmd_count > 0) {
+        target = frame;
+        band_total = (frame->height + RASTER_BAND_HEIGHT - 1) / RASTER_BAND_HEIGHT;
+        if (band_total > bin_count) band_total = bin_count;
+        SDL_AtomicSet(&next_band, 0);
+        for (int i = 0; i < worker_count; i++) SDL_SemPost(start);
+        rasterize_bands(); // This thread takes bands too
+        for (int i = 0; i < worker_count; i++) SDL_SemWait(done);
+    }
+    raster_discard();
+}
+
+void raster_discard(void) {
+    for (int b = 0; b < bin_count; b++) bins[b].count = 0;
+    cmd_count = 0;
+    span_count = 0;
+    point_count = 0;
+}
\ No newline at end of file
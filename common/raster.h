@@ -0,0 +1,40 @@
+#ifndef RASTER_H
+#define RASTER_H
+
+#include <SDL2/SDL.h>
+#include "frame.h"
+
+// Multithreaded rasterizer. With more than one thread, a frame's drawing
+// calls are recorded instead of run, each binned to the horizontal bands of
+// RASTER_BAND_HEIGHT rows it touches. end_frame then has a persistent pool
+// rasterize the bands in parallel: each band replays its calls in order,
+// clipped to its rows, so the pixels match drawing them directly.
+// Sprite and image data passed to a drawing call must stay valid until end_frame.
+#define RASTER_BAND_HEIGHT 32
+#define RASTER_MAX_THREADS 16
+
+// Start the pool: `threads` counts the caller, so 1 draws directly and
+// starts nothing. Returns 0 if the pool couldn't start
+int raster_init(int threads);
+void raster_shutdown(void);
+int raster_threads(void);
+
+// Recording, for the drawing primitives of a deferred frame. Each returns 0
+// (after rasterizing what's recorded so far) if the list can't grow; the
+// caller then draws directly
+int raster_push_fill(Frame *frame, int x, int y, int w, int h, Uint32 color);
+int raster_push_columns(Frame *frame, int x, int y, int w, int h, const int *top, const int *bottom, Uint32 color);
+int raster_push_shift(Frame *frame, int y, int h, int dx);
+int raster_push_sprite(Frame *frame, int x, int y, const Uint8 *sprite, int width, int height, int scale, Uint32 color);
+int raster_push_image(Frame *frame, int x, int y, const Uint32 *pixels, const Uint32 *mask, int width, int height);
+int raster_push_copy(Frame *frame, const Frame *layer, int x, int y, int w, int h);
+// Points are copied, each band getting only those on its rows
+int raster_push_points(Frame *frame, int x, int y, const int *xs, const int *ys, const Uint32 *colors,
+                       int count, int size);
+
+// Rasterize everything recorded for the frame and wait for it (end_frame does this)
+void raster_flush(Frame *frame);
+// Drop everything recorded (the frame is going away)
+void raster_discard(void);
+
+#endif // RASTER_H
\ No newline at end of file
@@ -0,0 +1,32 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <SDL2/SDL.h>
+
+// Small seedable generator (PCG32) so levels and replays don't depend on
+// the C library's rand()
+typedef struct {
+    Uint64 state;
+} Rng;
+
+static inline Uint32 rng_next(Rng *rng) {
+    Uint64 old = rng->state;
+    rng->state = old * 6364136223846793005ULL + 1442695040888963407ULL;
+    Uint32 xorshifted = (Uint32)(((old >> 18) ^ old) >> 27);
+    Uint32 rot = (Uint32)(old >> 59);
+    return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+}
+
+static inline void rng_seed(Rng *rng, Uint64 seed) {
+    rng->state = 0;
+    rng_next(rng);
+    rng->state += seed;
+    rng_next(rng);
+}
+
+// Uniform-ish integer in [0, n)
+static inline int rng_range(Rng *rng, int n) {
+    return (int)(rng_next(rng) % (Uint32)n);
+}
+
+#endif // RNG_H
\ No newline at end of file
@@ -0,0 +1,37 @@
+#include "timestep.h"
+#include "bench.h"
+
+void timestep_init(TimeStep *step) {
+    step->last = SDL_GetPerformanceCounter();
+    step->frame_start = step->last;
+    step->accumulator = 0.0;
+    step->alpha = 0.0f;
+    step->ticks = 0;
+}
+
+int timestep_advance(TimeStep *step) {
+    Uint64 now = SDL_GetPerformanceCounter();
+    double elapsed = (now - step->last) / (double)SDL_GetPerformanceFrequency();
+    if (bench_is_headless()) elapsed = 1.0 / 60.0;
+    step->last = now;
+    step->frame_start = now;
+
+    step->accumulator += elapsed;
+    int steps = (int)(step->accumulator * SIM_HZ);
+    if (steps > MAX_SIM_STEPS) {
+        // Drop the backlog rather than trying to catch up
+        steps = MAX_SIM_STEPS;
+        step->accumulator = steps * (double)SIM_DT;
+    }
+    step->accumulator -= steps * (double)SIM_DT;
+    if (step->accumulator < 0.0) step->accumulator = 0.0; // Rounding
+    step->alpha = (float)(step->accumulator * SIM_HZ);
+    step->ticks += steps;
+    return steps;
+}
+
+void timestep_throttle(const TimeStep *step) {
+    double elapsed_ms = (SDL_GetPerformanceCounter() - step->frame_start) * 1000.0 / SDL_GetPerformanceFrequency();
+    double frame_ms = 1000.0 / MAX_FRAME_HZ;
+    if (elapsed_ms < frame_ms) bench_delay((Uint32)(frame_ms - elapsed_ms));
+}
\ No newline at end of file
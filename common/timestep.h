@@ -0,0 +1,35 @@
+#ifndef TIMESTEP_H
+#define TIMESTEP_H
+
+#include <SDL2/SDL.h>
+
+// Simulation runs at a fixed rate, independent of the display
+#define SIM_HZ 120
+#define SIM_DT (1.0f / SIM_HZ)
+// Most ticks run in one frame; past this the game slows down instead of spiralling
+#define MAX_SIM_STEPS 10
+// Frames are capped so a missing vsync doesn't spin the CPU
+#define MAX_FRAME_HZ 240
+
+typedef struct {
+    Uint64 last;        // Performance counter at the previous frame
+    Uint64 frame_start; // Performance counter at this frame
+    double accumulator; // Wall time not yet simulated, in seconds
+    float alpha;        // Render blend from the previous tick (0) to the current one (1)
+    Uint64 ticks;       // Ticks simulated so far
+} TimeStep;
+
+// Start timing from now (call again after long pauses such as round changes)
+void timestep_init(TimeStep *step);
+// Measure the frame and return how many SIM_DT ticks to run (headless runs
+// advance exactly 1/60 s per frame so they're repeatable); sets alpha
+int timestep_advance(TimeStep *step);
+// Sleep off the rest of a MAX_FRAME_HZ frame (skipped in headless mode)
+void timestep_throttle(const TimeStep *step);
+
+// Blend between the previous and current tick
+static inline float timestep_lerp(float prev, float cur, float alpha) {
+    return prev + (cur - prev) * alpha;
+}
+
+#endif // TIMESTEP_H
\ No newline at end of file
@@ -0,0 +1,82 @@
+#include "trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct {
+    const char *name;
+    SDL_threadID thread;
+    Uint64 start, end; // Performance counter ticks
+} TraceEvent;
+
+static TraceEvent *events;
+static SDL_atomic_t next_event; // Total events recorded; wraps modulo the capacity
+static const char *trace_path;
+static Uint64 trace_base;
+
+int trace_init(const char *path) {
+    events = calloc(TRACE_CAPACITY, sizeof(TraceEvent));
+    if (!events) {
+        printf("Trace buffer allocation failed\n");
+        return 0;
+    }
+    SDL_AtomicSet(&next_event, 0);
+    trace_path = path;
+    trace_base = SDL_GetPerformanceCounter();
+    return 1;
+}
+
+void trace_shutdown(void) {
+    if (!events) return;
+    trace_dump();
+    free(events);
+    events = NULL;
+}
+
+Uint64 trace_begin(void) {
+    return SDL_GetPerformanceCounter();
+}
+
+void trace_end(const char *name, Uint64 start) {
+    if (!events) return;
+    Uint32 index = (Uint32)SDL_AtomicAdd(&next_event, 1);
+    TraceEvent *e = &events[index & (TRACE_CAPACITY - 1)];
+    e->name = name;
+    e->thread = SDL_ThreadID();
+    e->start = start;
+    e->end = SDL_GetPerformanceCounter();
+}
+
+int trace_dump(void) {
+    if (!events) return 0;
+    FILE *file = fopen(trace_path, "w");
+    if (!file) {
+        printf("Failed to open trace file %s\n", trace_path);
+        return 0;
+    }
+
+    // Oldest event first; timestamps in microseconds since trace_init
+    Uint32 next = (Uint32)SDL_AtomicGet(&next_event);
+    Uint32 count = next < TRACE_CAPACITY ? next : TRACE_CAPACITY; // The ring holds the latest
+    Uint32 first = next - count;
+    double us_per_tick = 1000000.0 / SDL_GetPerformanceFrequency();
+
+    fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    for (Uint32 i = 0; i < count; i++) {
+        const TraceEvent *e = &events[(first + i) & (TRACE_CAPACITY - 1)];
+        fprintf(file, "{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %lu, \"ts\": %.3f, \"dur\": %.3f}%s\n",
+                e->name, (unsigned long)e->thread,
+                (double)(Sint64)(e->start - trace_base) * us_per_tick,
+                (double)(e->end - e->start) * us_per_tick,
+                i + 1 < count ? "," : "");
+    }
+    fprintf(file, "]}\n");
+    fclose(file);
+    printf("Trace written to %s (%u events)\n", trace_path, count);
+    return 1;
+}
+
+void trace_handle_event(const SDL_Event *event) {
+    if (event->type == SDL_KEYDOWN && event->key.keysym.sym == SDLK_F12 && !event->key.repeat) {
+        trace_dump();
+    }
+}
\ No newline at end of file
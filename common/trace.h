@@ -0,0 +1,24 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <SDL2/SDL.h>
+
+// Events kept in the ring buffer; the oldest are overwritten (power of two)
+#define TRACE_CAPACITY 65536
+
+// Preallocate the ring buffer; dumps go to `path` as Chrome trace-event JSON
+int trace_init(const char *path);
+// Dump the buffer and free it
+void trace_shutdown(void);
+
+// Scoped timer: pair a trace_begin() with a trace_end() naming the phase.
+// `name` must outlive the trace (use string literals)
+Uint64 trace_begin(void);
+void trace_end(const char *name, Uint64 start);
+
+// Write the buffered events (open in chrome://tracing or ui.perfetto.dev)
+int trace_dump(void);
+// Dump on F12 so hitches can be captured while playing
+void trace_handle_event(const SDL_Event *event);
+
+#endif // TRACE_H
\ No newline at end of file
@@ -0,0 +1,86 @@
+#include "workers.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+struct WorkerPool {
+    SDL_Thread *threads[WORKERS_MAX_THREADS];
+    int thread_count; // Not counting the caller
+    SDL_sem *start, *done;
+    SDL_atomic_t next; // First item of the next batch
+    SDL_atomic_t quit;
+
+    // The loop being run (published to the threads by `start`)
+    WorkerFn fn;
+    void *data;
+    int count, batch;
+};
+
+// Take batches until there are none left
+static void take_batches(WorkerPool *pool) {
+    int first;
+    while ((first = SDL_AtomicAdd(&pool->next, pool->batch)) < pool->count) {
+        int last = pool->count - first > pool->batch ? first + pool->batch : pool->count;
+        pool->fn(pool->data, first, last);
+    }
+}
+
+static int SDLCALL worker_main(void *data) {
+    WorkerPool *pool = data;
+    for (;;) {
+        SDL_SemWait(pool->start);
+        if (SDL_AtomicGet(&pool->quit)) return 0;
+        take_batches(pool);
+        SDL_SemPost(pool->done); // Also publishes everything the batches wrote
+    }
+}
+
+WorkerPool *workers_create(int threads) {
+    if (threads < 1 || threads > WORKERS_MAX_THREADS) {
+        printf("Worker threads must be 1 to %d\n", WORKERS_MAX_THREADS);
+        return NULL;
+    }
+    WorkerPool *pool = calloc(1, sizeof(WorkerPool));
+    if (!pool) {
+        printf("Out of memory for the worker pool\n");
+        return NULL;
+    }
+    if (threads == 1) return pool;
+    pool->start = SDL_CreateSemaphore(0);
+    pool->done = SDL_CreateSemaphore(0);
+    for (int i = 0; pool->start && pool->done && i < threads - 1; i++) {
+        pool->threads[pool->thread_count] = SDL_CreateThread(worker_main, "worker", pool);
+        if (!pool->threads[pool->thread_count]) break;
+        pool->thread_count++;
+    }
+    if (pool->thread_count < threads - 1) {
+        printf("Worker threads failed to start: %s\n", SDL_GetError());
+        workers_destroy(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+void workers_destroy(WorkerPool *pool) {
+    if (!pool) return;
+    SDL_AtomicSet(&pool->quit, 1);
+    for (int i = 0; i < pool->thread_count; i++) SDL_SemPost(pool->start);
+    for (int i = 0; i < pool->thread_count; i++) SDL_WaitThread(pool->threads[i], NULL);
+    if (pool->start) SDL_DestroySemaphore(pool->start);
+    if (pool->done) SDL_DestroySemaphore(pool->done);
+    free(pool);
+}
+
+int workers_threads(const WorkerPool *pool) {
+    return pool->thread_count + 1;
+}
+
+void workers_run(WorkerPool *pool, int count, int batch, WorkerFn fn, void *data) {
+    pool->fn = fn;
+    pool->data = data;
+    pool->count = count;
+    pool->batch = batch < 1 ? 1 : batch;
+    SDL_AtomicSet(&pool->next, 0);
+    for (int i = 0; i < pool->thread_count; i++) SDL_SemPost(pool->start);
+    take_batches(pool);
+    for (int i = 0; i < pool->thread_count; i++) SDL_SemWait(pool->done);
+}
\ No newline at end of file
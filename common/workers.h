@@ -0,0 +1,25 @@
+#ifndef WORKERS_H
+#define WORKERS_H
+
+#include <SDL2/SDL.h>
+
+// Persistent pool for data-parallel loops: workers_run splits items
+// [0, count) into batches that the pool's threads and the caller take in
+// turn until none are left. A pool runs one loop at a time
+typedef struct WorkerPool WorkerPool;
+
+#define WORKERS_MAX_THREADS 64
+
+// Handle items [first, last)
+typedef void (*WorkerFn)(void *data, int first, int last);
+
+// Start a pool: `threads` counts the caller, so 1 starts nothing. Returns
+// NULL if the pool couldn't start
+WorkerPool *workers_create(int threads);
+void workers_destroy(WorkerPool *pool);
+int workers_threads(const WorkerPool *pool);
+
+// Run `fn` over [0, count) in batches of `batch` items and wait for all of it
+void workers_run(WorkerPool *pool, int count, int batch, WorkerFn fn, void *data);
+
+#endif // WORKERS_H
\ No newline at end of file
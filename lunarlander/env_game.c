@@ -0,0 +1,150 @@
+#include <SDL2/SDL.h>
+#include "env.h"
+#include "timestep.h"
+#include "lander.h"
+#include "lander_cache.h"
+#include "rng.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+
+// Lunar Lander as an environment: the action turns the lander and fires
+// its engine. The round ends on touchdown, with a reward of 1 for landing
+// safely on a pad and -1 for crashing.
+//
+// Instances share one world, generated up front and then only read, and
+// each round starts over the middle of a random screen of it. Each
+// instance keeps its lander, one array per field indexed by instance, so
+// a batch streams through only those and the ground stays in cache however
+// many instances run
+#define ENV_WORLD_SCREENS 64
+#define OBSERVATION_SIZE 9
+
+typedef struct {
+    int count;
+    World *world;
+    float *x, *y, *vel_x, *vel_y;
+    float *angle;
+    float *fuel;
+    Rng *rng; // Picks where each round starts
+} Instances;
+
+// Point the arrays into the block after the struct, each starting a cache
+// line (so batches of 16 instances never share one); with `instances`
+// NULL, only measure the block
+static size_t lay_out(Instances *instances, int n) {
+    Uint8 *base = instances ? (Uint8 *)(((uintptr_t)(instances + 1) + 63) & ~(uintptr_t)63) : NULL;
+    size_t size = 0;
+#define INSTANCE_ARRAY(field, type) \
+    size = (size + 63) & ~(size_t)63; \
+    if (instances) instances->field = (type *)(base + size); \
+    size += (size_t)n * sizeof(type);
+    INSTANCE_ARRAY(x, float)
+    INSTANCE_ARRAY(y, float)
+    INSTANCE_ARRAY(vel_x, float)
+    INSTANCE_ARRAY(vel_y, float)
+    INSTANCE_ARRAY(angle, float)
+    INSTANCE_ARRAY(fuel, float)
+    INSTANCE_ARRAY(rng, Rng)
+#undef INSTANCE_ARRAY
+    return size + 63; // And room to align the first
+}
+
+// New round: upright and at rest near the top of a random screen, with a
+// full tank
+static void reset(Instances *in, int i) {
+    int screen = (int)rng_range(&in->rng[i], ENV_WORLD_SCREENS);
+    in->x[i] = screen * SCREEN_WIDTH + SCREEN_WIDTH / 2.0f;
+    in->y[i] = 50.0f;
+    in->vel_x[i] = 0.0f;
+    in->vel_y[i] = 0.0f;
+    in->angle[i] = 0.0f;
+    in->fuel[i] = 100.0f;
+}
+
+static void *create(int n, unsigned int seed, const Uint32 *seeds) {
+    lander_cache_init(lander_sprite, flame_sprite); // Collision reads the rotation cache
+    World *world = world_create(ENV_WORLD_SCREENS);
+    if (!world) return NULL;
+    Rng rng;
+    rng_seed(&rng, seed);
+    world_generate(world, &rng);
+    Instances *in = calloc(1, sizeof(Instances) + lay_out(NULL, n));
+    if (!in) {
+        printf("Out of memory for %d LunarLander instances\n", n);
+        world_destroy(world);
+        return NULL;
+    }
+    lay_out(in, n);
+    in->count = n;
+    in->world = world;
+    for (int i = 0; i < n; i++) {
+        rng_seed(&in->rng[i], seeds[i]);
+        reset(in, i);
+    }
+    return in;
+}
+
+static void destroy(void *data) {
+    Instances *in = data;
+    world_destroy(in->world);
+    free(in);
+}
+
+// The lander's tick as the game runs it, on a copy gathered from the
+// arrays and scattered back
+static void step(void *data, int first, int last, const Uint8 *actions, float *rewards, Uint8 *dones) {
+    Instances *in = data;
+    Uint8 keys[SDL_NUM_SCANCODES] = {0};
+    for (int i = first; i < last; i++) {
+        Lander lander;
+        lander_init(&lander, in->x[i], in->y[i]);
+        lander.angle = lander.prev_angle = in->angle[i];
+        lander.vel_x = in->vel_x[i];
+        lander.vel_y = in->vel_y[i];
+        lander.fuel = in->fuel[i];
+        keys[SDL_SCANCODE_LEFT] = (actions[i] & ENV_LEFT) != 0;
+        keys[SDL_SCANCODE_RIGHT] = (actions[i] & ENV_RIGHT) != 0;
+        keys[SDL_SCANCODE_SPACE] = (actions[i] & ENV_THRUST) != 0;
+        int done = lander_step(&lander, keys, in->world, SIM_DT);
+
+        rewards[i] = !done ? 0.0f : lander.crashed ? -1.0f : 1.0f;
+        dones[i] = (Uint8)done;
+        if (done) {
+            reset(in, i);
+            continue;
+        }
+        in->x[i] = lander.x;
+        in->y[i] = lander.y;
+        in->vel_x[i] = lander.vel_x;
+        in->vel_y[i] = lander.vel_y;
+        in->angle[i] = lander.angle;
+        in->fuel[i] = lander.fuel;
+    }
+}
+
+// Lander position within its screen, velocity (hundreds of px/s),
+// attitude and fuel, then its height above the ground under it and how
+// far the nearest pad's middle is to its right. Positions are fractions
+// of the screen
+static void observe(const void *data, int first, int last, float *out) {
+    const Instances *in = data;
+    int width = in->world->width;
+    for (int i = first; i < last; i++) {
+        int column = (int)in->x[i] + 4;
+        if (column < 0) column = 0;
+        if (column >= width) column = width - 1;
+        *out++ = (in->x[i] - (column - column % SCREEN_WIDTH)) / SCREEN_WIDTH;
+        *out++ = in->y[i] / SCREEN_HEIGHT;
+        *out++ = in->vel_x[i] / 100.0f;
+        *out++ = in->vel_y[i] / 100.0f;
+        *out++ = sinf(in->angle[i]);
+        *out++ = cosf(in->angle[i]);
+        *out++ = in->fuel[i] / 100.0f;
+        *out++ = (world_ground(in->world, column) - (in->y[i] + 8)) / SCREEN_HEIGHT;
+        *out++ = (world_pad_center(column) - (in->x[i] + 4)) / SCREEN_WIDTH;
+    }
+}
+
+const EnvGame env_game = {"LunarLander", OBSERVATION_SIZE, create, destroy, step, observe};
\ No newline at end of file
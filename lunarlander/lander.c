@@ -0,0 +1,168 @@
+#include "lander.h"
+#include "lander_cache.h"
+#include <math.h>
+#include <limits.h>
+
+// Lander sprite (8x8)
+const Uint8 lander_sprite[8] = {
+    0b00011000, //    **   
+    0b00111100, //   ****  
+    0b01111110, //  ****** 
+    0b11111111, // ********
+    0b11011011, // ** ** **
+    0b10011001, // *  **  *
+    0b01000010, //  *    * 
+    0b00100100  //   *  *  
+};
+
+// Flame sprite (4x4, below lander when thrusting up)
+const Uint8 flame_sprite[4] = {
+    0b01100000, //  ** 
+    0b11110000, // ****
+    0b01100000, //  ** 
+    0b00100000  //  *  
+};
+
+// Lowest the lander can sit with its top-left at screen column x before its
+// outline touches the ground: the least of each column's ground less the
+// outline's depth there. `column` gets the column that sets it
+static int rest_height(const LanderFrame *frame, const World *world, int x, int *column) {
+    int cell_x = x - LANDER_CELL_OFFSET;
+    int rest = INT_MAX;
+    for (int col = frame->left; col <= frame->right; col++) {
+        int tx = cell_x + col;
+        if (frame->bottom[col] < 0 || tx < 0 || tx >= world->width) continue;
+        int r = world_ground(world, tx) - frame->bottom[col] - 1 + LANDER_CELL_OFFSET;
+        if (r < rest) {
+            rest = r;
+            if (column) *column = tx;
+        }
+    }
+    return rest;
+}
+
+// Sweep the outline from (x0, y0) to (x1, y1) against the ground; returns 1
+// with the fraction of the way it first touches and the column it touches
+// at. Touching is the outline's bottom row reaching the row above the
+// ground (the lander rests there)
+static int sweep_ground(const LanderFrame *frame, const World *world,
+                        float x0, float y0, float x1, float y1, float *toi, int *column) {
+    // Broad phase: the box the outline sweeps against the highest ground
+    // over the columns it crosses (from the world's pyramid)
+    int depth = 0;
+    for (int col = frame->left; col <= frame->right; col++) {
+        if (frame->bottom[col] > depth) depth = frame->bottom[col];
+    }
+    int first = (int)(x0 < x1 ? x0 : x1) - LANDER_CELL_OFFSET + frame->left;
+    int last = (int)(x0 > x1 ? x0 : x1) - LANDER_CELL_OFFSET + frame->right;
+    int ground, lowest_ground;
+    world_range(world, first, last, &ground, &lowest_ground);
+    int lowest = (int)(y0 > y1 ? y0 : y1) - LANDER_CELL_OFFSET + depth + 1; // First row under the box
+    if (lowest < ground) return 0;
+
+    // Narrow phase, a column of x at a time: within one the outline is over
+    // the same ground, so it touches when y reaches that column's rest height
+    float dx = x1 - x0, dy = y1 - y0;
+    int from = (int)x0, to = (int)x1;
+    int dir = to >= from ? 1 : -1;
+    float t_start = 0.0f;
+    for (int x = from;; x += dir) {
+        float t_end = x == to ? 1.0f : ((dir > 0 ? x + 1 : x) - x0) / dx;
+        int rest = rest_height(frame, world, x, column);
+        if (y0 + dy * t_start >= rest) { // Moved over higher ground
+            *toi = t_start;
+            return 1;
+        }
+        if (y0 + dy * t_end >= rest) { // Came down onto it (so dy > 0)
+            *toi = (rest - y0) / dy;
+            return 1;
+        }
+        if (x == to) return 0;
+        t_start = t_end;
+    }
+}
+
+void lander_init(Lander *lander, float x, float y) {
+    lander->x = lander->prev_x = x;
+    lander->y = lander->prev_y = y;
+    lander->angle = lander->prev_angle = 0.0f;
+    lander->vel_x = 0.0f;
+    lander->vel_y = 0.0f;
+    lander->fuel = 100.0f;
+    lander->thrusting = 0;
+    lander->main_engine = 0;
+    lander->landed = 0;
+    lander->crashed = 0;
+    lander->ticks = 0;
+}
+
+int lander_step(Lander *lander, const Uint8 *keys, const World *world, float dt) {
+    lander->prev_x = lander->x;
+    lander->prev_y = lander->y;
+    lander->prev_angle = lander->angle;
+    lander->thrusting = 0;
+    lander->main_engine = 0;
+    if (lander->landed) return 0;
+    lander->ticks++;
+
+    // Input: attitude jets turn the lander, the main engine pushes along its axis
+    if (keys[SDL_SCANCODE_LEFT]) {
+        lander->angle -= LANDER_TURN_RATE * dt; // Turn left, no fuel cost
+        lander->thrusting = 1;
+    }
+    if (keys[SDL_SCANCODE_RIGHT]) {
+        lander->angle += LANDER_TURN_RATE * dt; // Turn right, no fuel cost
+        lander->thrusting = 1;
+    }
+    lander->angle = remainderf(lander->angle, 2.0f * (float)M_PI);
+    if (keys[SDL_SCANCODE_SPACE] && lander->fuel > 0) {
+        lander->vel_x += sinf(lander->angle) * LANDER_THRUST * dt; // Thrust along the nose, consumes fuel
+        lander->vel_y -= cosf(lander->angle) * LANDER_THRUST * dt;
+        lander->fuel -= LANDER_FUEL_BURN * dt;
+        lander->thrusting = 1;
+        lander->main_engine = 1;
+    }
+
+    // Physics
+    lander->vel_y += LANDER_GRAVITY * dt;
+    lander->x += lander->vel_x * dt;
+    lander->y += lander->vel_y * dt;
+
+    // Bounds
+    if (lander->x < 0) lander->x = 0;
+    if (lander->x + 8 > world->width) lander->x = world->width - 8;
+
+    // Landing/crash check: sweep the rotated outline from where it was
+    const LanderFrame *frame = lander_cache_frame(lander->angle);
+    float toi;
+    int column = -1;
+    if (!sweep_ground(frame, world, lander->prev_x, lander->prev_y, lander->x, lander->y, &toi, &column)) return 0;
+
+    // Stop at the point of contact, resting on the ground there
+    LanderContact *contact = &lander->contact;
+    contact->x = lander->prev_x + (lander->x - lander->prev_x) * toi;
+    contact->y = lander->prev_y + (lander->y - lander->prev_y) * toi;
+    int rest = rest_height(frame, world, (int)contact->x, NULL);
+    if (contact->y > rest) contact->y = (float)rest; // Ran into a step: on top of it
+    contact->time = toi;
+    contact->column = column;
+
+    // Ground under the outline, from its first to its last column
+    int cell_x = (int)contact->x - LANDER_CELL_OFFSET;
+    int lander_left = cell_x + frame->left;
+    int lander_right = cell_x + frame->right + 1;
+    int left = lander_left < 0 ? 0 : lander_left;
+    int right = lander_right - 1 >= world->width ? world->width - 1 : lander_right - 1;
+    contact->slope = right > left ? (float)(world_ground(world, left) - world_ground(world, right)) / (right - left) : 0.0f;
+    contact->speed = (lander->vel_y + contact->slope * lander->vel_x) / sqrtf(1.0f + contact->slope * contact->slope);
+
+    lander->landed = 1;
+    lander->x = contact->x;
+    lander->y = contact->y;
+    lander->prev_x = lander->x; // No blending into the contact position
+    lander->prev_y = lander->y;
+    lander->prev_angle = lander->angle;
+    lander->crashed = contact->speed > LANDER_MAX_LANDING_SPEED || fabsf(lander->angle) > LANDER_MAX_LANDING_ANGLE ||
+                      !world_on_pad(world, lander_left, lander_right);
+    return 1;
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#ifndef LANDER_H
+#define LANDER_H
+
+#include <SDL2/SDL.h>
+#include "world.h"
+
+// Physics in pixels and seconds (tuned from the old per-frame values at 60 Hz)
+#define LANDER_GRAVITY 360.0f          // px/s^2
+#define LANDER_THRUST 720.0f           // px/s^2
+#define LANDER_FUEL_BURN 48.0f         // Fuel units per second of main engine
+#define LANDER_MAX_LANDING_SPEED 60.0f // px/s
+#define LANDER_TURN_RATE 3.14159265f   // rad/s (half a turn per second)
+#define LANDER_MAX_LANDING_ANGLE 0.2f  // rad either side of upright (just over one rotation step)
+
+// Lander sprite (8x8) and its flame (4x4, below the lander when thrusting up)
+extern const Uint8 lander_sprite[8];
+extern const Uint8 flame_sprite[4];
+
+// Where and how the lander touched down
+typedef struct {
+    float x, y;  // Lander position at the moment of impact
+    float time;  // Fraction of the tick it happened at
+    int column;  // World column that touched first
+    float speed; // Into the ground, px/s (along the ground's normal)
+    float slope; // Of the ground under the lander, rise per px to the right
+} LanderContact;
+
+// Lander state; prev_* is the previous tick, for render interpolation.
+// (x, y) is the top-left of the upright 8x8 sprite
+typedef struct {
+    float x, y, prev_x, prev_y;
+    float angle, prev_angle; // Radians clockwise from upright, kept in [-pi, pi]
+    float vel_x, vel_y;
+    float fuel;
+    int thrusting;   // Main engine or attitude jets fired this tick
+    int main_engine; // Main engine fired this tick (draws the flame)
+    int landed;      // Touched down, safely or not
+    int crashed;
+    LanderContact contact; // Set on touchdown
+    Uint64 ticks;    // Ticks simulated this round
+} Lander;
+
+void lander_init(Lander *lander, float x, float y);
+// Advance one tick of `dt` seconds; returns 1 on the tick the lander touches down.
+// The lander's outline is swept along the whole tick against the terrain,
+// so it lands where it first touched however fast it moves. Collision uses
+// the rotation cache, so lander_cache_init must have run
+int lander_step(Lander *lander, const Uint8 *keys, const World *world, float dt);
+
+#endif // LANDER_H
\ No newline at end of file
@@ -0,0 +1,68 @@
+#include "lander_cache.h"
+#include <math.h>
+
+static LanderFrame frames[LANDER_ANGLES];
+
+static const Uint32 lander_colors[LANDER_COLORS] = {0xFFFF00FF, 0x00FF00FF, 0xFF0000FF};
+static const Uint32 flame_colors[FLAME_COLORS] = {0xFF8000FF};
+
+// Nearest-neighbour rotation of a size x size 1bpp sprite about its center,
+// into the middle of a cell x cell mask
+static void rotate_mask(const Uint8 *sprite, int size, float angle, int cell, Uint32 *mask) {
+    float c = cosf(angle), s = sinf(angle);
+    for (int dy = 0; dy < cell; dy++) {
+        for (int dx = 0; dx < cell; dx++) {
+            float u = dx + 0.5f - cell / 2.0f;
+            float v = dy + 0.5f - cell / 2.0f;
+            int sx = (int)floorf(c * u + s * v + size / 2.0f);
+            int sy = (int)floorf(-s * u + c * v + size / 2.0f);
+            int set = sx >= 0 && sx < size && sy >= 0 && sy < size && (sprite[sy] & (0x80 >> sx));
+            mask[dy * cell + dx] = set ? 0xFFFFFFFFu : 0;
+        }
+    }
+}
+
+void lander_cache_init(const Uint8 *lander_sprite, const Uint8 *flame_sprite) {
+    for (int a = 0; a < LANDER_ANGLES; a++) {
+        LanderFrame *f = &frames[a];
+        float angle = a * 2.0f * (float)M_PI / LANDER_ANGLES;
+
+        rotate_mask(lander_sprite, 8, angle, LANDER_CELL, f->mask);
+        for (int i = 0; i < LANDER_CELL * LANDER_CELL; i++) {
+            for (int c = 0; c < LANDER_COLORS; c++) {
+                f->pixels[c][i] = f->mask[i] & lander_colors[c];
+            }
+        }
+
+        // Collision profile
+        f->left = LANDER_CELL;
+        f->right = -1;
+        for (int col = 0; col < LANDER_CELL; col++) {
+            f->bottom[col] = -1;
+            for (int row = 0; row < LANDER_CELL; row++) {
+                if (f->mask[row * LANDER_CELL + col]) f->bottom[col] = (Sint8)row;
+            }
+            if (f->bottom[col] >= 0) {
+                if (col < f->left) f->left = (Sint8)col;
+                f->right = (Sint8)col;
+            }
+        }
+
+        // The flame sits 6 pixels below the lander's center and turns with it
+        float flame_dx = -6.0f * sinf(angle), flame_dy = 6.0f * cosf(angle);
+        f->flame_x = (int)lroundf(LANDER_CELL / 2.0f + flame_dx - FLAME_CELL / 2.0f);
+        f->flame_y = (int)lroundf(LANDER_CELL / 2.0f + flame_dy - FLAME_CELL / 2.0f);
+        rotate_mask(flame_sprite, 4, angle, FLAME_CELL, f->flame_mask);
+        for (int i = 0; i < FLAME_CELL * FLAME_CELL; i++) {
+            for (int c = 0; c < FLAME_COLORS; c++) {
+                f->flame_pixels[c][i] = f->flame_mask[i] & flame_colors[c];
+            }
+        }
+    }
+}
+
+const LanderFrame *lander_cache_frame(float angle) {
+    int index = (int)lroundf(angle * LANDER_ANGLES / (2.0f * (float)M_PI)) % LANDER_ANGLES;
+    if (index < 0) index += LANDER_ANGLES;
+    return &frames[index];
+}
\ No newline at end of file
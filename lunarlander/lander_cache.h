@@ -0,0 +1,43 @@
+#ifndef LANDER_CACHE_H
+#define LANDER_CACHE_H
+
+#include <SDL2/SDL.h>
+
+// Rotation steps around the full circle (11.25 degrees each)
+#define LANDER_ANGLES 32
+// Any rotation of the 8x8 lander fits in a 12x12 cell centered on it, so the
+// cell's top-left is 2 pixels up and left of the unrotated sprite
+#define LANDER_CELL 12
+#define LANDER_CELL_OFFSET 2
+// Any rotation of the 4x4 flame fits in 6x6
+#define FLAME_CELL 6
+
+typedef enum {
+    LANDER_YELLOW,  // Flying
+    LANDER_GREEN,   // Landed safely
+    LANDER_RED,     // Crashed
+    LANDER_COLORS
+} LanderColor;
+
+typedef enum {
+    FLAME_ORANGE,
+    FLAME_COLORS
+} FlameColor;
+
+// One rotation, pre-expanded for draw_image
+typedef struct {
+    Uint32 pixels[LANDER_COLORS][LANDER_CELL * LANDER_CELL];
+    Uint32 mask[LANDER_CELL * LANDER_CELL];
+    Sint8 bottom[LANDER_CELL];  // Collision mask: lowest solid row per column, -1 if empty
+    Sint8 left, right;          // First and last solid column
+    Uint32 flame_pixels[FLAME_COLORS][FLAME_CELL * FLAME_CELL];
+    Uint32 flame_mask[FLAME_CELL * FLAME_CELL];
+    int flame_x, flame_y;       // Flame cell relative to the lander cell
+} LanderFrame;
+
+// Rotate and color both sprites for every angle (once, at startup)
+void lander_cache_init(const Uint8 *lander_sprite, const Uint8 *flame_sprite);
+// Nearest cached rotation for `angle` (radians, clockwise, 0 = upright)
+const LanderFrame *lander_cache_frame(float angle);
+
+#endif // LANDER_CACHE_H
\ No newline at end of file
@@ -1,36 +1,19 @@
 #include <SDL2/SDL.h>
-#include <SDL2/SDL_mixer.h>
+#include "frame.h"
+#include "audio.h"
+#include "assets.h"
+#include "blit.h"
+#include "bench.h"
+#include "trace.h"
+#include "timestep.h"
+#include "lander.h"
+#include "lander_cache.h"
+#include "input.h"
+#include "rng.h"
+#include "particles.h"
 #include <stdio.h>
 #include <math.h>
 
-// Global screen dimensions
-const int SCREEN_WIDTH = 800;
-const int SCREEN_HEIGHT = 600;
-
-// Global pixel buffer and pitch
-Uint32 *pixels;
-int pitch;
-
-// Lander sprite (8x8)
-const Uint8 lander_sprite[8] = {
-    0b00011000, //    **   
-    0b00111100, //   ****  
-    0b01111110, //  ****** 
-    0b11111111, // ********
-    0b11011011, // ** ** **
-    0b10011001, // *  **  *
-    0b01000010, //  *    * 
-    0b00100100  //   *  *  
-};
-
-// Flame sprite (4x4, below lander when thrusting up)
-const Uint8 flame_sprite[4] = {
-    0b01100000, //  ** 
-    0b11110000, // ****
-    0b01100000, //  ** 
-    0b00100000  //  *  
-};
-
 // Digit sprites (5x5, 0-9)
 const Uint8 digit_sprites[10][5] = {
     {0b11110, 0b10010, 0b10010, 0b10010, 0b11110}, // 0
@@ -45,91 +28,387 @@ const Uint8 digit_sprites[10][5] = {
     {0b11110, 0b10010, 0b11110, 0b00010, 0b11110}  // 9
 };
 
-// Draw sprite
-void draw_sprite(int x, int y, const Uint8 *sprite, int width, int height, Uint32 color, SDL_Texture *texture) {
-    SDL_LockTexture(texture, NULL, (void **)&pixels, &pitch);
-    int bytes_per_row = pitch / sizeof(Uint32);
-
-    for (int row = 0; row < height; row++) {
-        if (y + row < 0 || y + row >= SCREEN_HEIGHT) continue;
-        Uint8 bits = sprite[row];
-        for (int col = 0; col < width; col++) {
-            if (x + col < 0 || x + col >= SCREEN_WIDTH) continue;
-            if (bits & (1 << (7 - col))) {
-                pixels[(y + row) * bytes_per_row + (x + col)] = color;
-            }
-        }
-    }
-    SDL_UnlockTexture(texture);
+// Draw a cached rotation of the lander whose upright sprite would sit at (x, y)
+static void draw_lander(int x, int y, const LanderFrame *cached, LanderColor color, Frame *frame) {
+    draw_image(x - LANDER_CELL_OFFSET, y - LANDER_CELL_OFFSET, cached->pixels[color], cached->mask,
+               LANDER_CELL, LANDER_CELL, frame);
 }
 
-// Draw terrain
-void draw_terrain(int *terrain, SDL_Texture *texture) {
-    SDL_LockTexture(texture, NULL, (void **)&pixels, &pitch);
-    int bytes_per_row = pitch / sizeof(Uint32);
-
-    for (int x = 0; x < SCREEN_WIDTH; x++) {
-        for (int y = terrain[x]; y < SCREEN_HEIGHT; y++) {
-            pixels[y * bytes_per_row + x] = 0x808080FF; // Gray terrain
-        }
-    }
-    SDL_UnlockTexture(texture);
+static void draw_flame(int x, int y, const LanderFrame *cached, FlameColor color, Frame *frame) {
+    draw_image(x - LANDER_CELL_OFFSET + cached->flame_x, y - LANDER_CELL_OFFSET + cached->flame_y,
+               cached->flame_pixels[color], cached->flame_mask, FLAME_CELL, FLAME_CELL, frame);
 }
 
 // Draw score/fuel text
-void draw_text(int x, int y, const char *text, SDL_Texture *texture) {
+void draw_text(int x, int y, const char *text, Frame *frame) {
     for (int i = 0; text[i]; i++) {
         int digit = text[i] - '0';
         if (digit >= 0 && digit <= 9) {
-            draw_sprite(x + i * 6, y, digit_sprites[digit], 5, 5, 0xFFFFFFFF, texture);
+            draw_sprite(x + i * 6, y, digit_sprites[digit], 5, 5, 0xFFFFFFFF, frame);
         }
     }
 }
 
-// Draw fuel gauge (20x100, left side)
-void draw_fuel_gauge(float fuel, SDL_Texture *texture) {
-    SDL_LockTexture(texture, NULL, (void **)&pixels, &pitch);
-    int bytes_per_row = pitch / sizeof(Uint32);
-    int gauge_x = 10; // Left side
-    int gauge_y = 50; // Below score
-    int gauge_width = 20;
-    int gauge_height = 100;
-    int fuel_height = (int)(fuel * gauge_height / 100.0f); // Scale fuel to 0-100
-
-    // Clear gauge area
-    for (int y = gauge_y; y < gauge_y + gauge_height; y++) {
-        for (int x = gauge_x - 1; x < gauge_x + gauge_width + 1; x++) {
-            pixels[y * bytes_per_row + x] = 0x000000FF; // Black background
-        }
+// Fuel gauge (20x100, left side, below the score)
+#define GAUGE_X 10
+#define GAUGE_Y 50
+#define GAUGE_WIDTH 20
+#define GAUGE_HEIGHT 100
+
+// Score text, up to 9 digits
+#define SCORE_X 10
+#define SCORE_Y 10
+#define SCORE_WIDTH (9 * 6)
+
+// Draw the fuel gauge's border (the bar goes inside it)
+static void draw_gauge_border(Frame *frame) {
+    fill_rect(frame, GAUGE_X - 1, GAUGE_Y, GAUGE_WIDTH + 2, 1, 0xFFFFFFFF); // Top
+    fill_rect(frame, GAUGE_X - 1, GAUGE_Y + GAUGE_HEIGHT, GAUGE_WIDTH + 2, 1, 0xFFFFFFFF); // Bottom
+    fill_rect(frame, GAUGE_X - 1, GAUGE_Y, 1, GAUGE_HEIGHT, 0xFFFFFFFF); // Left
+    fill_rect(frame, GAUGE_X + GAUGE_WIDTH, GAUGE_Y, 1, GAUGE_HEIGHT, 0xFFFFFFFF); // Right
+}
+
+// World width in screens
+#define WORLD_SCREENS 1000
+
+// Farthest the camera zooms out, as a pyramid level (2^level world pixels
+// to a screen pixel)
+#define CAMERA_MAX_LEVEL 4
+// Screen rows kept above the lander before zooming out, and needed at the
+// nearer zoom before zooming back in
+#define CAMERA_ZOOM_OUT_MARGIN 40
+#define CAMERA_ZOOM_IN_MARGIN 160
+
+// What the screen shows: the world from column x and row y at its top-left,
+// zoomed out 2^level times. The bottom edge stays on world row
+// SCREEN_HEIGHT, below the lowest ground
+typedef struct {
+    int x, y;
+    int level;
+} Camera;
+
+// Screen position of a world position along one axis
+static int to_screen(int world, int origin, int level) {
+    int d = world - origin;
+    return d >= 0 ? d >> level : -((-d + (1 << level) - 1) >> level); // Rounded down either way
+}
+
+// Zoom out as the lander climbs, and scroll once it leaves the middle third
+// of the screen. Returns 1 if the view changed
+static int camera_follow(Camera *camera, const World *world, int x, int y) {
+    Camera old = *camera;
+    int level = camera->level;
+    while (level < CAMERA_MAX_LEVEL && (SCREEN_WIDTH << (level + 1)) <= world->width &&
+           (SCREEN_HEIGHT - y) >> level > SCREEN_HEIGHT - CAMERA_ZOOM_OUT_MARGIN) {
+        level++;
+    }
+    while (level > 0 && (SCREEN_HEIGHT - y) >> (level - 1) <= SCREEN_HEIGHT - CAMERA_ZOOM_IN_MARGIN) level--;
+
+    int view = SCREEN_WIDTH << level;
+    if (level != camera->level) {
+        camera->x = x - view / 2; // Centered after a zoom
+    } else if (x < camera->x + view / 3) {
+        camera->x = x - view / 3;
+    } else if (x > camera->x + 2 * view / 3) {
+        camera->x = x - 2 * view / 3;
     }
+    if (camera->x > world->width - view) camera->x = world->width - view;
+    if (camera->x < 0) camera->x = 0;
+    camera->x &= ~((1 << level) - 1); // Whole pyramid entries per screen column
+    camera->y = SCREEN_HEIGHT - (SCREEN_HEIGHT << level);
+    camera->level = level;
+    return camera->x != old.x || camera->y != old.y || camera->level != old.level;
+}
 
-    // Draw border
-    for (int x = gauge_x - 1; x < gauge_x + gauge_width + 1; x++) {
-        pixels[gauge_y * bytes_per_row + x] = 0xFFFFFFFF; // Top
-        pixels[(gauge_y + gauge_height) * bytes_per_row + x] = 0xFFFFFFFF; // Bottom
+// Static background: black sky, terrain and the gauge's border. It's drawn
+// when the camera moves, and whatever moves over it is erased by copying
+// it back from here
+static Frame *background;
+
+// Draw the background as the camera sees it, reading one pyramid entry per
+// screen column (the highest ground under it) whatever the zoom
+static void draw_background(const World *world, const Camera *camera) {
+    int top[SCREEN_WIDTH];
+    const Sint16 *min = world->min[camera->level];
+    int first = camera->x >> camera->level;
+    int entries = world_level_width(world, camera->level);
+    for (int col = 0; col < SCREEN_WIDTH; col++) {
+        top[col] = first + col < entries ? (min[first + col] - camera->y) >> camera->level : SCREEN_HEIGHT;
     }
-    for (int y = gauge_y; y < gauge_y + gauge_height; y++) {
-        pixels[y * bytes_per_row + gauge_x - 1] = 0xFFFFFFFF; // Left
-        pixels[y * bytes_per_row + gauge_x + gauge_width] = 0xFFFFFFFF; // Right
+    clear_frame(background, 0x000000FF); // Black sky
+    fill_columns(background, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, top, NULL, 0x808080FF); // Gray terrain
+    draw_gauge_border(background);
+}
+
+// Put the background back under a screen rectangle
+static void restore(Frame *frame, int x, int y, int w, int h) {
+    copy_rect(frame, background, x, y, w, h);
+}
+
+// Height of the fuel bar (fuel runs 0-100)
+static int fuel_height(float fuel) {
+    return (int)(fuel * GAUGE_HEIGHT / 100.0f);
+}
+
+// Draw fuel bar (bottom-up) over the background inside the gauge
+void draw_fuel_gauge(int fuel_height, Frame *frame) {
+    restore(frame, GAUGE_X, GAUGE_Y, GAUGE_WIDTH, GAUGE_HEIGHT);
+    fill_rect(frame, GAUGE_X, GAUGE_Y + GAUGE_HEIGHT - fuel_height, GAUGE_WIDTH, fuel_height, 0x00FF00FF); // Green fuel
+}
+
+// 1 if a screen rectangle overlaps the score or the fuel gauge
+static int touches_hud(const SDL_Rect *rect) {
+    SDL_Rect gauge = {GAUGE_X - 1, GAUGE_Y, GAUGE_WIDTH + 2, GAUGE_HEIGHT + 1};
+    SDL_Rect score = {SCORE_X, SCORE_Y, SCORE_WIDTH, 5};
+    return SDL_HasIntersection(rect, &gauge) || SDL_HasIntersection(rect, &score);
+}
+
+// Erase the lander and its flame as last drawn; returns 1 if that touched the HUD
+static int erase_lander(int x, int y, const LanderFrame *cached, Frame *frame) {
+    SDL_Rect hull = {x - LANDER_CELL_OFFSET, y - LANDER_CELL_OFFSET, LANDER_CELL, LANDER_CELL};
+    SDL_Rect flame = {hull.x + cached->flame_x, hull.y + cached->flame_y, FLAME_CELL, FLAME_CELL};
+    restore(frame, hull.x, hull.y, hull.w, hull.h);
+    restore(frame, flame.x, flame.y, flame.w, flame.h);
+    return touches_hud(&hull) || touches_hud(&flame);
+}
+
+// Effects, in world coordinates: exhaust from the main engine, and debris
+// or dust on touchdown. They have a generator of their own so they never
+// change a round
+#define EFFECT_PARTICLES 16384
+#define EXHAUST_PER_TICK 6
+#define DEBRIS_PARTICLES 400
+#define DUST_PARTICLES 40
+// Ticks the touchdown stays on screen (with its effects) before the next round
+#define TOUCHDOWN_TICKS SIM_HZ
+static Particles *particles;
+static Rng effects_rng;
+
+static const Uint32 exhaust_colors[] = {0xFFFFA0FF, 0xFFC000FF, 0xFF8000FF};
+static const Uint32 debris_colors[] = {0xFFFF00FF, 0xFF8000FF, 0xFF0000FF, 0x808080FF};
+static const Uint32 dust_colors[] = {0x808080FF, 0xB0B0B0FF};
+static const ParticleEmitter exhaust = {0.0f, 0.25f, 150.0f, 300.0f, 0.2f, 0.5f, exhaust_colors, SDL_arraysize(exhaust_colors)};
+static const ParticleEmitter debris = {0.0f, (float)M_PI, 40.0f, 260.0f, 0.6f, 1.6f, debris_colors, SDL_arraysize(debris_colors)};
+static const ParticleEmitter dust = {0.0f, 1.4f, 20.0f, 90.0f, 0.2f, 0.6f, dust_colors, SDL_arraysize(dust_colors)};
+
+// Spray exhaust from the engine at the lander's tail, away from its nose
+static void emit_exhaust(const Lander *lander) {
+    ParticleEmitter spray = exhaust;
+    spray.angle = lander->angle + (float)M_PI;
+    float x = lander->x + 4.0f - sinf(lander->angle) * 4.0f;
+    float y = lander->y + 4.0f + cosf(lander->angle) * 4.0f;
+    particles_emit(particles, &spray, &effects_rng, EXHAUST_PER_TICK, x, y, lander->vel_x, lander->vel_y);
+}
+
+// Debris for a crash, or a puff of dust for a landing
+static void emit_touchdown(const Lander *lander) {
+    float x = lander->x + 4.0f, y = lander->y + 8.0f;
+    if (lander->crashed) {
+        particles_emit(particles, &debris, &effects_rng, DEBRIS_PARTICLES, x, y - 4.0f, 0.0f, 0.0f);
+    } else {
+        particles_emit(particles, &dust, &effects_rng, DUST_PARTICLES, x, y, 0.0f, 0.0f);
     }
+}
+
+// One world per run, generated at startup; each round starts above a
+// different screen of it. Seeded once so replays rebuild the same rounds
+static Rng rng;
+static World *world;
+
+// Play one round (until landing or crash); returns 0 when the game should exit
+static int play_round(SDL_Renderer *renderer, SDL_Texture *texture,
+                      Sound *thruster_sound, Sound *crash_sound, Sound *land_sound) {
+    // Start above a random screen, just right of its pad
+    float start_x = rng_range(&rng, world->width / SCREEN_WIDTH) * SCREEN_WIDTH + SCREEN_WIDTH / 2.0f;
+    Camera camera = {(int)start_x - SCREEN_WIDTH / 2, 0, 0};
+    camera_follow(&camera, world, (int)start_x, 50);
+    draw_background(world, &camera);
+
+    Frame *frame = begin_frame(texture);
+    if (!frame) return 0;
+    restore(frame, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+    end_frame(frame);
+
+    // Game state
+    int running = 1;
+    int quit = 0;
+    Lander lander;
+    lander_init(&lander, start_x, 50.0f);
+    int drawn_x = -LANDER_CELL, drawn_y = -LANDER_CELL; // Where (on screen) and how the lander was last drawn
+    const LanderFrame *drawn = lander_cache_frame(lander.angle);
+    int score = 0;
+    int drawn_score = -1, drawn_fuel = -1; // HUD as last drawn, -1 to redraw
+    SDL_Rect drawn_effects = {0, 0, 0, 0};  // Around the particles as last drawn
+    int touchdown_ticks = 0;                // Left before the round ends, once landed
+    particles_clear(particles);
+    AudioVoice thruster = 0; // Looping thruster voice, 0 when silent
+    SDL_Event event;
+    TimeStep step;
+    timestep_init(&step);
+
+    while (running) {
+        bench_frame_begin();
+        Uint64 frame_trace = trace_begin();
+
+        // Handle quit event
+        Uint64 phase = trace_begin();
+        while (SDL_PollEvent(&event)) {
+            if (event.type == SDL_QUIT) {
+                running = 0;
+                quit = 1;
+            }
+            input_handle_event(&event);
+            trace_handle_event(&event);
+        }
+        trace_end("input", phase);
+
+        // Physics at the fixed tick rate
+        phase = trace_begin();
+        int steps = timestep_advance(&step);
+        int thrusting = 0;
+        int ticks = 0;
+        for (; ticks < steps && running; ticks++) {
+            if (!input_tick()) break;
+            if (lander.landed) { // Showing the touchdown (and hearing it)
+                if (--touchdown_ticks == 0) running = 0;
+                continue;
+            }
+            if (lander_step(&lander, input_keys(), world, SIM_DT)) {
+                if (lander.crashed) {
+                    audio_play(crash_sound, AUDIO_PRIORITY_HIGH, 0);
+                    if (!bench_is_headless()) printf("Crashed! Score: %d\n", score);
+                } else {
+                    audio_play(land_sound, AUDIO_PRIORITY_HIGH, 0);
+                    score += 50;
+                    if (!bench_is_headless()) printf("Landed! Score: %d\n", score);
+                }
+                emit_touchdown(&lander);
+                touchdown_ticks = TOUCHDOWN_TICKS;
+            }
+            if (lander.main_engine) emit_exhaust(&lander);
+            thrusting |= lander.thrusting;
+        }
+        particles_update(particles, ticks * SIM_DT);
+
+        // Sound control (thruster)
+        if (thrusting && !thruster && lander.fuel > 0) {
+            thruster = audio_play(thruster_sound, AUDIO_PRIORITY_NORMAL, 1);
+        } else if (!thrusting && thruster) {
+            audio_stop(thruster);
+            thruster = 0;
+        }
+        trace_end("update", phase);
+
+        // Draw at the position blended between the last two ticks, redrawing
+        // the background first if that moved the camera (the layer can't
+        // change between begin_frame and end_frame)
+        phase = trace_begin();
+        int lander_x = (int)timestep_lerp(lander.prev_x, lander.x, step.alpha);
+        int lander_y = (int)timestep_lerp(lander.prev_y, lander.y, step.alpha);
+        int moved = camera_follow(&camera, world, lander_x, lander_y);
+        if (moved) draw_background(world, &camera);
+        frame = begin_frame(texture);
+        if (!frame) return 0;
+        if (moved) {
+            restore(frame, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+            drawn_score = drawn_fuel = -1;
+        } else {
+            restore(frame, drawn_effects.x, drawn_effects.y, drawn_effects.w, drawn_effects.h);
+            if (erase_lander(drawn_x, drawn_y, drawn, frame) || touches_hud(&drawn_effects)) {
+                drawn_score = drawn_fuel = -1; // Took a bite out of the HUD
+            }
+        }
+
+        // Effects, a tick behind like everything else, then the HUD over them
+        ParticleView view = {(float)camera.x, (float)camera.y, 1.0f / (1 << camera.level),
+                             (step.alpha - 1.0f) * SIM_DT, camera.level ? 1 : 2};
+        drawn_effects = particles_render(particles, frame, &view);
+        if (touches_hud(&drawn_effects)) drawn_score = drawn_fuel = -1;
+
+        // HUD, where it changed
+        if (score != drawn_score) {
+            char score_str[10];
+            snprintf(score_str, 10, "%d", score);
+            restore(frame, SCORE_X, SCORE_Y, SCORE_WIDTH, 5);
+            draw_text(SCORE_X, SCORE_Y, score_str, frame); // Score text
+            drawn_score = score;
+        }
+        if (fuel_height(lander.fuel) != drawn_fuel) {
+            drawn_fuel = fuel_height(lander.fuel);
+            draw_fuel_gauge(drawn_fuel, frame); // Fuel gauge
+        }
+
+        // The lander over the terrain and the HUD, full size at any zoom with
+        // its bottom middle where it is in the world
+        drawn_x = to_screen(lander_x + 4, camera.x, camera.level) - 4;
+        drawn_y = to_screen(lander_y + 8, camera.y, camera.level) - 8;
+        drawn = lander_cache_frame(lander.prev_angle + remainderf(lander.angle - lander.prev_angle, 2.0f * (float)M_PI) * step.alpha);
+        if (!lander.landed) {
+            draw_lander(drawn_x, drawn_y, drawn, LANDER_YELLOW, frame);
+            // Blinking flame when thrusting
+            if (lander.main_engine && (lander.ticks % 16) < 8) {
+                draw_flame(drawn_x, drawn_y, drawn, FLAME_ORANGE, frame);
+            }
+        } else {
+            draw_lander(drawn_x, drawn_y, drawn, lander.crashed ? LANDER_RED : LANDER_GREEN, frame);
+        }
+        trace_end("render", phase);
+        end_frame(frame);
+
+        // Render
+        phase = trace_begin();
+        SDL_RenderClear(renderer);
+        SDL_RenderCopy(renderer, texture, NULL, NULL);
+        SDL_RenderPresent(renderer);
+        trace_end("present", phase);
 
-    // Draw fuel bar (bottom-up)
-    for (int y = gauge_y + gauge_height - fuel_height; y < gauge_y + gauge_height; y++) {
-        for (int x = gauge_x; x < gauge_x + gauge_width; x++) {
-            pixels[y * bytes_per_row + x] = 0x00FF00FF; // Green fuel
+        trace_end("frame", frame_trace);
+        if (!bench_frame_end()) {
+            running = 0; // Headless frame budget spent
+            quit = 1;
         }
+        timestep_throttle(&step);
     }
-    SDL_UnlockTexture(texture);
+    audio_stop(thruster);
+    return !quit;
 }
 
+
+// Headless input: pulse the main engine to hover and tilt left and right
+static const ScriptedKey input_script[] = {
+    {SDL_SCANCODE_SPACE, 12, 5, 0},
+    {SDL_SCANCODE_LEFT, 90, 10, 0},
+    {SDL_SCANCODE_RIGHT, 90, 10, 45},
+};
+
 int main(int argc, char *argv[]) {
+    BenchOptions options = {.seed = 1};
+    if (!bench_parse_args(argc, argv, &options) ||
+        !bench_init(&options, input_script, SDL_arraysize(input_script))) {
+        return 1;
+    }
+    rng_seed(&rng, bench_seed());
+    lander_cache_init(lander_sprite, flame_sprite);
+    background = create_layer(SCREEN_WIDTH, SCREEN_HEIGHT);
+    world = world_create(WORLD_SCREENS);
+    particles = particles_create(EFFECT_PARTICLES, LANDER_GRAVITY);
+    if (!background || !world || !particles) {
+        destroy_layer(background);
+        world_destroy(world);
+        particles_destroy(particles);
+        bench_shutdown();
+        return 1;
+    }
+    world_generate(world, &rng);
+    rng_seed(&effects_rng, bench_seed());
+
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0) {
         printf("SDL Init failed: %s\n", SDL_GetError());
         return 1;
     }
 
-    if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
-        printf("SDL_mixer Init failed: %s\n", Mix_GetError());
+    if (!audio_init()) {
+        printf("Audio Init failed: %s\n", SDL_GetError());
         SDL_Quit();
         return 1;
     }
@@ -139,16 +418,16 @@ int main(int argc, char *argv[]) {
                                           SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
     if (!window) {
         printf("Window creation failed: %s\n", SDL_GetError());
-        Mix_CloseAudio();
+        audio_shutdown();
         SDL_Quit();
         return 1;
     }
 
-    SDL_Renderer *renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    SDL_Renderer *renderer = SDL_CreateRenderer(window, -1, bench_renderer_flags());
     if (!renderer) {
         printf("Renderer creation failed: %s\n", SDL_GetError());
         SDL_DestroyWindow(window);
-        Mix_CloseAudio();
+        audio_shutdown();
         SDL_Quit();
         return 1;
     }
@@ -160,171 +439,49 @@ int main(int argc, char *argv[]) {
         printf("Texture creation failed: %s\n", SDL_GetError());
         SDL_DestroyRenderer(renderer);
         SDL_DestroyWindow(window);
-        Mix_CloseAudio();
+        audio_shutdown();
         SDL_Quit();
         return 1;
     }
 
-    // Load sound effects
-    Mix_Chunk *thruster_sound = Mix_LoadWAV("thruster.wav");
-    Mix_Chunk *crash_sound = Mix_LoadWAV("crash.wav");
-    Mix_Chunk *land_sound = Mix_LoadWAV("land.wav");
+    // Sound effects, played straight from the packed archive
+    int assets_ok = assets_open("lunarlander.pak");
+    Sound *thruster_sound = assets_ok ? assets_acquire_sound("thruster.wav") : NULL;
+    Sound *crash_sound = assets_ok ? assets_acquire_sound("crash.wav") : NULL;
+    Sound *land_sound = assets_ok ? assets_acquire_sound("land.wav") : NULL;
     if (!thruster_sound || !crash_sound || !land_sound) {
-        printf("Failed to load sound: %s\n", Mix_GetError());
-        if (thruster_sound) Mix_FreeChunk(thruster_sound);
-        if (crash_sound) Mix_FreeChunk(crash_sound);
-        if (land_sound) Mix_FreeChunk(land_sound);
+        audio_shutdown();
+        assets_close();
         SDL_DestroyTexture(texture);
         SDL_DestroyRenderer(renderer);
         SDL_DestroyWindow(window);
-        Mix_CloseAudio();
         SDL_Quit();
         return 1;
     }
 
-    // Clear screen
-    SDL_LockTexture(texture, NULL, (void **)&pixels, &pitch);
-    for (int i = 0; i < SCREEN_WIDTH * SCREEN_HEIGHT; i++) {
-        pixels[i] = 0x000000FF; // Black sky
-    }
-    SDL_UnlockTexture(texture);
-
-    // Terrain (jagged with flat spot at 300-340)
-    int terrain[SCREEN_WIDTH];
-    for (int x = 0; x < SCREEN_WIDTH; x++) {
-        if (x >= 300 && x <= 340) {
-            terrain[x] = SCREEN_HEIGHT - 50; // Flat landing pad
-        } else {
-            terrain[x] = SCREEN_HEIGHT - 50 - (rand() % 30); // Jagged elsewhere
-        }
-    }
-    draw_terrain(terrain, texture);
-
-    // Game state
-    int running = 1;
-    float lander_x = SCREEN_WIDTH / 2.0f;
-    float lander_y = 50.0f;
-    float last_x = lander_x, last_y = lander_y;
-    float last_flame_x = lander_x + 2, last_flame_y = lander_y + 8;
-    float vel_x = 0.0f, vel_y = 0.0f;
-    float fuel = 100.0f;
-    int score = 0;
-    int landed = 0;
-    int frame_count = 0;
-    int sound_playing = 0;
-    SDL_Event event;
-    const float GRAVITY = 0.1f;
-    const float THRUST = 0.2f;
-    const float MAX_LANDING_SPEED = 1.0f;
-
-    while (running) {
-        // Handle quit event
-        while (SDL_PollEvent(&event)) {
-            if (event.type == SDL_QUIT) {
-                running = 0;
-            }
-        }
-
-        // Input (polling keys)
-        const Uint8 *state = SDL_GetKeyboardState(NULL);
-        int thrusting = 0;
-        if (!landed) {
-            if (state[SDL_SCANCODE_LEFT]) {
-                vel_x -= THRUST; // Thrust left, no fuel cost
-                thrusting = 1;
-            }
-            if (state[SDL_SCANCODE_RIGHT]) {
-                vel_x += THRUST; // Thrust right, no fuel cost
-                thrusting = 1;
-            }
-            if (state[SDL_SCANCODE_SPACE] && fuel > 0) {
-                vel_y -= THRUST; // Thrust up, consumes fuel
-                fuel -= 0.8f; // 4x faster depletion (was 0.2f)
-                thrusting = 1;
-            }
-        }
-
-        // Sound control (thruster)
-        if (thrusting && !sound_playing && fuel > 0) {
-            Mix_PlayChannel(1, thruster_sound, -1); // Channel 1, looped
-            sound_playing = 1;
-        } else if (!thrusting && sound_playing) {
-            Mix_HaltChannel(1);
-            sound_playing = 0;
-        }
-
-        // Physics
-        if (!landed) {
-            vel_y += GRAVITY; // Gravity
-            last_x = lander_x;
-            last_y = lander_y;
-            last_flame_x = lander_x + 2;
-            last_flame_y = lander_y + 8;
-            lander_x += vel_x;
-            lander_y += vel_y;
-
-            // Bounds
-            if (lander_x < 0) lander_x = 0;
-            if (lander_x + 8 > SCREEN_WIDTH) lander_x = SCREEN_WIDTH - 8;
-
-            // Landing/crash check
-            int lander_bottom = (int)lander_y + 8;
-            int lander_left = (int)lander_x;
-            int lander_right = lander_left + 8;
-            if (lander_bottom >= terrain[lander_left] || lander_bottom >= terrain[lander_right]) {
-                landed = 1;
-                lander_y = terrain[lander_left] - 8; // Snap to surface
-                if (vel_y > MAX_LANDING_SPEED || lander_left < 300 || lander_right > 340) {
-                    Mix_PlayChannel(2, crash_sound, 0); // Crash sound
-                    printf("Crashed! Score: %d\n", score);
-                    SDL_Delay(1000); // Pause to hear crash
-                    running = 0;
-                } else {
-                    Mix_PlayChannel(2, land_sound, 0); // Land sound
-                    printf("Landed! Score: %d\n", score += 50);
-                    SDL_Delay(1000); // Pause to hear landing
-                    running = 0;
-                }
-            }
-        }
-
-        // Draw
-        draw_sprite((int)last_x, (int)last_y, lander_sprite, 8, 8, 0x000000FF, texture); // Erase lander
-        draw_sprite((int)last_flame_x, (int)last_flame_y, flame_sprite, 4, 4, 0x000000FF, texture); // Erase flame
-        if (!landed) {
-            draw_sprite((int)lander_x, (int)lander_y, lander_sprite, 8, 8, 0xFFFF00FF, texture); // Yellow lander
-            // Blinking flame when thrusting up
-            if (state[SDL_SCANCODE_SPACE] && fuel > 0 && (frame_count % 8) < 4) {
-                draw_sprite((int)lander_x + 2, (int)lander_y + 8, flame_sprite, 4, 4, 0xFF8000FF, texture); // Orange flame
-            }
-        } else {
-            draw_sprite((int)lander_x, (int)lander_y, lander_sprite, 8, 8, vel_y > MAX_LANDING_SPEED ? 0xFF0000FF : 0x00FF00FF, texture); // Red if crashed, green if safe
-        }
-        draw_terrain(terrain, texture); // Redraw terrain
-
-        // Draw HUD
-        char score_str[10];
-        snprintf(score_str, 10, "%d", score);
-        draw_text(10, 10, score_str, texture); // Score text
-        draw_fuel_gauge(fuel, texture); // Fuel gauge
-
-        // Render
-        SDL_RenderClear(renderer);
-        SDL_RenderCopy(renderer, texture, NULL, NULL);
-        SDL_RenderPresent(renderer);
+    // Phase timings; F12 or exit writes them out (tracing is skipped if allocation fails)
+    trace_init("lunarlander_trace.json");
 
-        frame_count++;
-        SDL_Delay(16); // ~60 FPS
+    // Headless runs start a new round whenever one ends, until the frame budget is spent
+    while (play_round(renderer, texture, thruster_sound, crash_sound, land_sound) && bench_is_headless()) {
     }
 
     // Cleanup
-    Mix_FreeChunk(thruster_sound);
-    Mix_FreeChunk(crash_sound);
-    Mix_FreeChunk(land_sound);
+    bench_report("LunarLander");
+    bench_shutdown();
+    trace_shutdown();
+    destroy_frame();
+    destroy_layer(background);
+    world_destroy(world);
+    particles_destroy(particles);
+    audio_shutdown(); // Stop mixing before the sounds go away
+    assets_release_sound(thruster_sound);
+    assets_release_sound(crash_sound);
+    assets_release_sound(land_sound);
+    assets_close();
     SDL_DestroyTexture(texture);
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
-    Mix_CloseAudio();
     SDL_Quit();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,340 @@
+#include <SDL2/SDL.h>
+#include "lander.h"
+#include "lander_cache.h"
+#include "timestep.h"
+#include "workers.h"
+#include "hash.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Level validator: generates the world the game would for a seed and width
+// (the game's is 1000 screens), then flies the lander's own physics step
+// from many sampled starts (position, velocity, fuel) over every screen
+// under a handful of landing autopilots, aiming at the screen's own pad and
+// its neighbours'. A pad is reachable if any start lands on it safely with
+// the fuel it had. Starts are independent and seeded by their index, so
+// result_hash must match across thread counts.
+//
+// By default the sweep is sized to take seconds: a few starts per screen,
+// and a start that lands on its own pad doesn't try the neighbours'.
+// --exhaustive flies a hundred starts per screen at every pad in reach
+
+// Longest flight tried; fuel runs out long before
+#define MAX_TICKS (30 * SIM_HZ)
+
+// Pads tried from each start: its own screen's and the ones either side
+#define PAD_OFFSETS 3
+
+// Starts per screen unless --samples says otherwise
+#define QUICK_SAMPLES_PER_SCREEN 4
+#define EXHAUSTIVE_SAMPLES_PER_SCREEN 100
+
+// Lander outline's reach either side of its sprite, rotated
+#define OUTLINE_MARGIN LANDER_CELL_OFFSET
+
+// Final descent speed the autopilots aim for, under the landing limit
+#define TOUCH_SPEED 30.0f
+
+// Where and how a flight starts
+typedef struct {
+    float x, y, vel_x, vel_y;
+    float fuel;
+} Start;
+
+// An autopilot: burns as late as it dares (stopping `margin` px above the
+// ground) and crosses to the pad at up to `approach` px/s, tilting at most
+// `tilt` rad to get there
+typedef struct {
+    float margin;
+    float approach;
+    float tilt;
+} Policy;
+
+// Careful first, so the fuel left is the most a start can keep
+static const Policy policies[] = {
+    {40.0f, 80.0f, 0.5f},
+    {15.0f, 80.0f, 0.5f},
+    {40.0f, 200.0f, 0.9f},
+    {15.0f, 200.0f, 0.9f},
+    {5.0f, 350.0f, 1.2f},
+};
+#define POLICY_COUNT ((int)(sizeof(policies) / sizeof(policies[0])))
+
+typedef struct {
+    const World *world;
+    unsigned int seed;
+    int screens;
+    int exhaustive; // Try the neighbours' pads even after landing on its own
+    // Per start and pad offset: fuel left on landing, or -1 if not reached
+    float *fuel_left;
+    Uint32 *flights; // Flights flown per start
+    Uint32 *ticks;   // Ticks simulated per start
+} Sweep;
+
+static float clampf(float v, float lo, float hi) {
+    return v < lo ? lo : v > hi ? hi : v;
+}
+
+// Highest ground (least y) under the lander's outline at x
+static int ground_under(const World *world, float x) {
+    int min_y, max_y;
+    world_range(world, (int)x - OUTLINE_MARGIN, (int)x + 8 + OUTLINE_MARGIN, &min_y, &max_y);
+    return min_y;
+}
+
+// The start for sample `index`: the first sample of each screen is the
+// game's own round start (over the middle of the screen, still, full
+// tank), the rest are random over the screen's upper part
+static void make_start(const Sweep *sweep, int index, Start *start) {
+    int screen = index % sweep->screens;
+    if (index < sweep->screens) {
+        start->x = screen * SCREEN_WIDTH + SCREEN_WIDTH / 2.0f;
+        start->y = 50.0f;
+        start->vel_x = start->vel_y = 0.0f;
+        start->fuel = 100.0f;
+        return;
+    }
+    Rng rng;
+    rng_seed(&rng, ((Uint64)sweep->seed << 32) ^ (Uint64)index);
+    start->x = screen * SCREEN_WIDTH + (float)rng_range(&rng, SCREEN_WIDTH - 8);
+    int ground = ground_under(sweep->world, start->x);
+    int room = ground - 8 - 60; // Leave the lander a little air to turn in
+    start->y = room > 0 ? (float)rng_range(&rng, room < 300 ? room : 300) : 0.0f;
+    start->vel_x = (float)(rng_range(&rng, 201) - 100);
+    start->vel_y = (float)(rng_range(&rng, 151) - 50);
+    start->fuel = (float)(20 + rng_range(&rng, 81));
+}
+
+// An autopilot flying one start toward the pad centred on column pad_x,
+// with the highest ground between the lander and the pad as of `column`
+typedef struct {
+    const Policy *policy;
+    int pad_x;
+    int column, ridge;
+} Pilot;
+
+// One tick of the autopilot
+static void autopilot(Pilot *pilot, const Lander *lander, const World *world, Uint8 *keys) {
+    const Policy *policy = pilot->policy;
+    float center = lander->x + 4.0f;
+    float dx = pilot->pad_x - center;
+    int over_pad = fabsf(dx) < 8.0f;
+
+    // Keep clear of the ridges between here and the pad until over it (the
+    // ridge only changes when the lander crosses a column)
+    float floor_y;
+    if (over_pad) {
+        floor_y = (float)ground_under(world, lander->x);
+    } else {
+        if ((int)center != pilot->column) {
+            int lowest;
+            pilot->column = (int)center;
+            int from = pilot->column < pilot->pad_x ? pilot->column : pilot->pad_x;
+            int to = pilot->column < pilot->pad_x ? pilot->pad_x : pilot->column;
+            world_range(world, from - 8, to + 8, &pilot->ridge, &lowest);
+        }
+        floor_y = pilot->ridge - policy->margin;
+    }
+    float height = floor_y - (lander->y + 8.0f);
+
+    // Sideways: lean into the speed wanted, upright for the last stretch
+    float want_vx = clampf(dx * 1.5f, -policy->approach, policy->approach);
+    float want_angle = clampf((want_vx - lander->vel_x) * 0.01f, -policy->tilt, policy->tilt);
+    if (over_pad && height < 60.0f) want_angle = 0.0f;
+    keys[SDL_SCANCODE_LEFT] = lander->angle > want_angle + 0.03f;
+    keys[SDL_SCANCODE_RIGHT] = lander->angle < want_angle - 0.03f;
+
+    // Down: fall until the engine can only just stop by `margin` px above
+    // the floor, then follow that profile in
+    float decel = LANDER_THRUST * cosf(lander->angle) - LANDER_GRAVITY;
+    if (decel < 60.0f) decel = 60.0f;
+    float room = height - policy->margin;
+    float want_vy = room > 0.0f ? sqrtf(2.0f * decel * room) : 0.0f;
+    if (over_pad && want_vy < TOUCH_SPEED) want_vy = TOUCH_SPEED;
+    int burn = lander->vel_y > want_vy;
+    // Crossing to the pad also takes the engine (without climbing away)
+    if (!over_pad && fabsf(want_vx - lander->vel_x) > 20.0f && lander->vel_y > -60.0f) burn = 1;
+    keys[SDL_SCANCODE_SPACE] = (Uint8)burn;
+}
+
+// Fly one start under one autopilot; returns the fuel left on a safe
+// landing on the pad at pad_x, or -1
+static float fly(const Start *start, const Policy *policy, const World *world, int pad_x, Uint32 *ticks) {
+    Uint8 keys[SDL_NUM_SCANCODES] = {0};
+    Pilot pilot = {policy, pad_x, -1, 0};
+    Lander lander;
+    lander_init(&lander, start->x, start->y);
+    lander.vel_x = start->vel_x;
+    lander.vel_y = start->vel_y;
+    lander.fuel = start->fuel;
+    while (lander.ticks < MAX_TICKS) {
+        autopilot(&pilot, &lander, world, keys);
+        if (lander_step(&lander, keys, world, SIM_DT)) break;
+        // Out of fuel and already falling too fast for the (flat) pad:
+        // gravity only makes it worse
+        if (lander.fuel <= 0.0f && lander.vel_y > LANDER_MAX_LANDING_SPEED) break;
+    }
+    *ticks += (Uint32)lander.ticks;
+    if (!lander.landed || lander.crashed) return -1.0f;
+    if (world_pad_center(lander.contact.column) != pad_x) return -1.0f; // Safe, but on another pad
+    return lander.fuel > 0.0f ? lander.fuel : 0.0f;
+}
+
+// Worker: each start against each pad in reach (its own first), trying
+// autopilots in turn until one lands
+static void sweep_starts(void *data, int first, int last) {
+    static const int pad_order[PAD_OFFSETS] = {1, 0, 2};
+    Sweep *sweep = data;
+    for (int i = first; i < last; i++) {
+        Start start;
+        make_start(sweep, i, &start);
+        int screen = i % sweep->screens;
+        float *fuel_left = &sweep->fuel_left[(size_t)i * PAD_OFFSETS];
+        for (int o = 0; o < PAD_OFFSETS; o++) fuel_left[o] = -1.0f;
+        sweep->flights[i] = 0;
+        sweep->ticks[i] = 0;
+        for (int n = 0; n < PAD_OFFSETS; n++) {
+            int o = pad_order[n];
+            int pad_screen = screen + o - 1;
+            float *fuel = &fuel_left[o];
+            if (n > 0 && !sweep->exhaustive && fuel_left[1] >= 0.0f) break; // Landed at home
+            if (pad_screen < 0 || pad_screen >= sweep->screens) continue;
+            int pad_x = world_pad_center(pad_screen * SCREEN_WIDTH);
+            for (int p = 0; p < POLICY_COUNT && *fuel < 0.0f; p++) {
+                sweep->flights[i]++;
+                *fuel = fly(&start, &policies[p], sweep->world, pad_x, &sweep->ticks[i]);
+            }
+        }
+    }
+}
+
+// Everything main acquires; any of it may be NULL
+static void release(World *world, Sweep *sweep, int *landings, float *best_fuel, WorkerPool *pool) {
+    workers_destroy(pool);
+    free(sweep->fuel_left);
+    free(sweep->flights);
+    free(sweep->ticks);
+    free(landings);
+    free(best_fuel);
+    world_destroy(world);
+}
+
+int main(int argc, char *argv[]) {
+    unsigned int seed = 1;
+    int screens = 1000, samples = 0, threads = SDL_GetCPUCount(), list_pads = 0, exhaustive = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--screens") == 0 && i + 1 < argc) {
+            screens = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc) {
+            samples = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--pads") == 0) {
+            list_pads = 1;
+        } else if (strcmp(argv[i], "--exhaustive") == 0) {
+            exhaustive = 1;
+        } else {
+            printf("Usage: %s [--seed S] [--screens N] [--samples N] [--threads N] [--pads] [--exhaustive]\n",
+                   argv[0]);
+            return 1;
+        }
+    }
+    if (samples == 0 && screens > 0) {
+        samples = screens * (exhaustive ? EXHAUSTIVE_SAMPLES_PER_SCREEN : QUICK_SAMPLES_PER_SCREEN);
+    }
+    if (screens < 1 || samples < screens) {
+        printf("Need at least one screen and a sample per screen\n");
+        return 1;
+    }
+    if (threads > WORKERS_MAX_THREADS) threads = WORKERS_MAX_THREADS;
+
+    // The world the game generates from this seed
+    lander_cache_init(lander_sprite, flame_sprite);
+    World *world = world_create(screens);
+    if (!world) return 1;
+    Rng rng;
+    rng_seed(&rng, seed);
+    world_generate(world, &rng);
+
+    Sweep sweep = {world, seed, screens, exhaustive, NULL, NULL, NULL};
+    sweep.fuel_left = malloc((size_t)samples * PAD_OFFSETS * sizeof(float));
+    sweep.flights = malloc((size_t)samples * sizeof(Uint32));
+    sweep.ticks = malloc((size_t)samples * sizeof(Uint32));
+    int *landings = calloc(screens, sizeof(int));
+    float *best_fuel = malloc(screens * sizeof(float));
+    if (!sweep.fuel_left || !sweep.flights || !sweep.ticks || !landings || !best_fuel) {
+        printf("Out of memory for %d samples\n", samples);
+        release(world, &sweep, landings, best_fuel, NULL);
+        return 1;
+    }
+    WorkerPool *pool = workers_create(threads); // Reports its own failure
+    if (!pool) {
+        release(world, &sweep, landings, best_fuel, NULL);
+        return 1;
+    }
+
+    Uint64 begin = SDL_GetPerformanceCounter();
+    workers_run(pool, samples, 64, sweep_starts, &sweep);
+    double seconds = (SDL_GetPerformanceCounter() - begin) / (double)SDL_GetPerformanceFrequency();
+
+    // Tally in sample order. A start's ease is 0 if it can't land anywhere,
+    // else half for landing plus half the share of its fuel it has left on
+    // its best landing; difficulty is 100 less the mean ease in percent
+    for (int s = 0; s < screens; s++) best_fuel[s] = -1.0f;
+    Uint32 hash = HASH_INIT;
+    long long flights = 0, ticks = 0;
+    int landable = 0, round_starts = 0;
+    double ease = 0.0;
+    for (int i = 0; i < samples; i++) {
+        int screen = i % screens;
+        float best = -1.0f;
+        for (int o = 0; o < PAD_OFFSETS; o++) {
+            float fuel = sweep.fuel_left[(size_t)i * PAD_OFFSETS + o];
+            hash = hash_bytes(hash, &fuel, sizeof(fuel));
+            if (fuel < 0.0f) continue;
+            int pad = screen + o - 1;
+            landings[pad]++;
+            if (fuel > best_fuel[pad]) best_fuel[pad] = fuel;
+            if (fuel > best) best = fuel;
+        }
+        if (best >= 0.0f) {
+            Start start;
+            make_start(&sweep, i, &start);
+            landable++;
+            if (i < screens) round_starts++;
+            ease += 0.5 + 0.5 * best / start.fuel;
+        }
+        flights += sweep.flights[i];
+        ticks += sweep.ticks[i];
+    }
+    int reachable = 0;
+    for (int s = 0; s < screens; s++) reachable += landings[s] > 0;
+    double difficulty = 100.0 * (1.0 - ease / samples);
+
+    printf("{\"seed\": %u, \"screens\": %d, \"samples\": %d, \"exhaustive\": %d, \"threads\": %d, \"seconds\": %.3f, "
+           "\"flights\": %lld, \"ticks_per_second\": %.0f, \"landable\": %.4f, \"round_starts_landable\": %d, "
+           "\"pads_reachable\": %d, \"difficulty\": %.1f, \"result_hash\": \"%08x\", \"unreachable_pads\": [",
+           seed, screens, samples, exhaustive, threads, seconds, flights, ticks / seconds, landable / (double)samples,
+           round_starts, reachable, difficulty, hash);
+    int listed = 0;
+    for (int s = 0; s < screens; s++) {
+        if (landings[s] == 0) printf("%s%d", listed++ ? ", " : "", world_pad_center(s * SCREEN_WIDTH));
+    }
+    printf("]");
+    if (list_pads) {
+        printf(", \"pads\": [");
+        for (int s = 0; s < screens; s++) {
+            printf("%s{\"x\": %d, \"landings\": %d, \"best_fuel\": %.1f}", s ? ", " : "",
+                   world_pad_center(s * SCREEN_WIDTH), landings[s], best_fuel[s] > 0.0f ? best_fuel[s] : 0.0f);
+        }
+        printf("]");
+    }
+    printf("}\n");
+
+    release(world, &sweep, landings, best_fuel, pool);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,118 @@
+#include "world.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Ground level of the flats (the pad when there are no hills)
+#define WORLD_GROUND (SCREEN_HEIGHT - 50)
+// Hills: a random height every WORLD_HILL_SPACING columns, eased between
+#define WORLD_HILL_SPACING 256
+#define WORLD_HILL_HEIGHT 240
+// Jagged ground sticks up to this much above the hills
+#define WORLD_JAG 30
+
+World *world_create(int screens) {
+    World *world = calloc(1, sizeof(World));
+    if (!world) {
+        printf("World allocation failed\n");
+        return NULL;
+    }
+    world->width = screens * SCREEN_WIDTH;
+    world->levels = 1;
+    while ((1 << (world->levels - 1)) < world->width && world->levels < WORLD_MAX_LEVELS) world->levels++;
+
+    // One block: the ground, then both halves of every level above it
+    size_t entries = (size_t)world->width;
+    for (int level = 1; level < world->levels; level++) entries += 2 * (size_t)world_level_width(world, level);
+    Sint16 *block = malloc(entries * sizeof(Sint16));
+    if (!block) {
+        printf("World allocation failed (%d columns)\n", world->width);
+        free(world);
+        return NULL;
+    }
+    world->min[0] = world->max[0] = block;
+    block += world->width;
+    for (int level = 1; level < world->levels; level++) {
+        world->min[level] = block;
+        block += world_level_width(world, level);
+        world->max[level] = block;
+        block += world_level_width(world, level);
+    }
+    return world;
+}
+
+void world_destroy(World *world) {
+    if (!world) return;
+    free(world->min[0]);
+    free(world);
+}
+
+void world_generate(World *world, Rng *rng) {
+    Sint16 *ground = world->min[0];
+    int from = rng_range(rng, WORLD_HILL_HEIGHT);
+    for (int x0 = 0; x0 < world->width; x0 += WORLD_HILL_SPACING) {
+        int to = rng_range(rng, WORLD_HILL_HEIGHT);
+        for (int i = 0; i < WORLD_HILL_SPACING && x0 + i < world->width; i++) {
+            float t = (float)i / WORLD_HILL_SPACING;
+            t = t * t * (3.0f - 2.0f * t);
+            ground[x0 + i] = (Sint16)(WORLD_GROUND - from - (int)((to - from) * t));
+        }
+        from = to;
+    }
+
+    // Jagged, except the pads, which stay flat at the hill's height where they start
+    for (int x = 0; x < world->width; x++) {
+        int pad_left = x - x % SCREEN_WIDTH + PAD_LEFT;
+        if (x >= pad_left && x <= pad_left + PAD_RIGHT - PAD_LEFT) {
+            ground[x] = ground[pad_left];
+        } else {
+            ground[x] = (Sint16)(ground[x] - rng_range(rng, WORLD_JAG));
+        }
+    }
+
+    // Each level from pairs of the one below (an odd last entry covers one)
+    for (int level = 1; level < world->levels; level++) {
+        const Sint16 *min_below = world->min[level - 1], *max_below = world->max[level - 1];
+        int below = world_level_width(world, level - 1);
+        Sint16 *min = world->min[level], *max = world->max[level];
+        for (int i = 0; 2 * i < below; i++) {
+            int a = 2 * i, b = 2 * i + 1 < below ? 2 * i + 1 : 2 * i;
+            min[i] = min_below[a] < min_below[b] ? min_below[a] : min_below[b];
+            max[i] = max_below[a] > max_below[b] ? max_below[a] : max_below[b];
+        }
+    }
+}
+
+void world_range(const World *world, int first, int last, int *min_y, int *max_y) {
+    int lo = INT_MAX, hi = INT_MIN;
+    if (first < 0) first = 0;
+    if (last >= world->width) last = world->width - 1;
+
+    // Climb while trimming the ends to whole entries of the next level up
+    for (int level = 0; first <= last; level++) {
+        if (first & 1) {
+            if (world->min[level][first] < lo) lo = world->min[level][first];
+            if (world->max[level][first] > hi) hi = world->max[level][first];
+            first++;
+        }
+        if (!(last & 1) && first <= last) {
+            if (world->min[level][last] < lo) lo = world->min[level][last];
+            if (world->max[level][last] > hi) hi = world->max[level][last];
+            last--;
+        }
+        first >>= 1;
+        last = (last - 1) >> 1;
+    }
+    *min_y = lo;
+    *max_y = hi;
+}
+
+int world_on_pad(const World *world, int left, int right) {
+    if (left < 0 || right > world->width) return 0;
+    int pad_left = left - left % SCREEN_WIDTH + PAD_LEFT;
+    return left >= pad_left && right <= pad_left + PAD_RIGHT - PAD_LEFT;
+}
+
+int world_pad_center(int x) {
+    return x - x % SCREEN_WIDTH + (PAD_LEFT + PAD_RIGHT) / 2;
+}
\ No newline at end of file
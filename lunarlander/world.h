@@ -0,0 +1,52 @@
+#ifndef WORLD_H
+#define WORLD_H
+
+#include <SDL2/SDL.h>
+#include "rng.h"
+
+// Screen dimensions
+#define SCREEN_WIDTH 800
+#define SCREEN_HEIGHT 600
+
+// Flat landing pad, at the same place in every screen-wide stretch of ground
+#define PAD_LEFT 300
+#define PAD_RIGHT 340
+
+// Pyramid levels a world can have (level l covers 2^l columns per entry)
+#define WORLD_MAX_LEVELS 32
+
+// Ground as one height per column (a y, in screen rows, so down is +), plus a
+// pyramid of the least and greatest y over each aligned run of 2^l columns.
+// Ranges of any length are then answered from O(log n) entries, and a view
+// zoomed out 2^l times reads one entry per screen column
+typedef struct {
+    int width;                    // Columns, SCREEN_WIDTH per screen
+    int levels;                   // Pyramid levels; level 0 is the ground itself
+    Sint16 *min[WORLD_MAX_LEVELS]; // Highest ground over each 2^level columns
+    Sint16 *max[WORLD_MAX_LEVELS]; // Lowest ground over them
+} World;
+
+// Make a world `screens` screens wide (ground not generated yet). Returns
+// NULL on failure
+World *world_create(int screens);
+void world_destroy(World *world);
+// Rolling jagged hills with a flat pad in every screen, then the pyramid
+void world_generate(World *world, Rng *rng);
+
+// Ground y at column x (in the world)
+static inline int world_ground(const World *world, int x) {
+    return world->min[0][x];
+}
+// Entries at a pyramid level
+static inline int world_level_width(const World *world, int level) {
+    return (world->width + (1 << level) - 1) >> level;
+}
+// Least and greatest ground y over columns [first, last] (clipped to the
+// world; an empty range gives INT_MAX and INT_MIN)
+void world_range(const World *world, int first, int last, int *min_y, int *max_y);
+// 1 if columns [left, right) are all on one pad
+int world_on_pad(const World *world, int left, int right);
+// Column in the middle of the pad of the screen-wide stretch holding x
+int world_pad_center(int x);
+
+#endif // WORLD_H
\ No newline at end of file
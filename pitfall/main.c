@@ -1,7 +1,62 @@
 #include "scroller.h"
+#include "bench.h"
+#include "trace.h"
+#include "timestep.h"
+#include "input.h"
+#include "pipeline.h"
 #include <stdio.h>
+#include <time.h>
+
+// Headless input: run right, jumping now and then, with the odd step back
+static const ScriptedKey input_script[] = {
+    {SDL_SCANCODE_RIGHT, 240, 200, 0},
+    {SDL_SCANCODE_LEFT, 240, 20, 210},
+    {SDL_SCANCODE_SPACE, 45, 3, 10},
+};
+
+// One frame of simulation, drawn while the next one is simulated (--pipeline)
+typedef struct {
+    GameState game;
+    float alpha;
+    int over; // Fell into a pit (headless runs start a new game instead)
+} Snapshot;
+
+// The simulation's own state, touched only by simulate()
+static GameState game;
+static Rng rng;
+
+static Snapshot snapshots[2];
+static int front = 0;     // Snapshot being drawn; the simulation writes the other
+static int steps_to_run;  // Ticks in the frame being simulated
+static float step_alpha;  // Where that frame is drawn between its last two ticks
+
+// Run a frame's fixed ticks into the back snapshot
+static void simulate(void *data) {
+    (void)data;
+    Uint64 phase = trace_begin();
+    int alive = 1;
+    for (int i = 0; i < steps_to_run && alive; i++) {
+        if (!input_tick()) break;
+        alive = update_game(&game, input_keys(), SIM_DT);
+    }
+    if (!alive && bench_is_headless()) {
+        init_game(&game, &rng); // Keep going until the frame budget is spent
+        alive = 1;
+    }
+    Snapshot *snap = &snapshots[!front];
+    snap->game = game;
+    snap->alpha = step_alpha;
+    snap->over = !alive;
+    trace_end("update", phase);
+}
 
 int main(int argc, char *argv[]) {
+    BenchOptions options = {.seed = (unsigned int)time(NULL)}; // Random level unless --seed is given
+    if (!bench_parse_args(argc, argv, &options) ||
+        !bench_init(&options, input_script, SDL_arraysize(input_script))) {
+        return 1;
+    }
+
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
         printf("SDL Init failed: %s\n", SDL_GetError());
         return 1;
@@ -16,7 +71,7 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
-    SDL_Renderer *renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    SDL_Renderer *renderer = SDL_CreateRenderer(window, -1, bench_renderer_flags());
     if (!renderer) {
         printf("Renderer creation failed: %s\n", SDL_GetError());
         SDL_DestroyWindow(window);
@@ -35,29 +90,79 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
-    GameState game;
-    init_game(&game, texture);
+    rng_seed(&rng, bench_seed());
+    init_game(&game, &rng);
+    snapshots[front] = (Snapshot){.game = game};
+
+    // Phase timings; F12 or exit writes them out (tracing is skipped if allocation fails)
+    trace_init("pitfall_trace.json");
 
+    // Pipelined, frame N is drawn and presented while N + 1 is simulated
+    int pipelined = bench_is_pipelined() && pipeline_init(simulate, NULL);
     int running = 1;
     SDL_Event event;
+    TimeStep step;
+    timestep_init(&step);
     while (running) {
+        bench_frame_begin();
+        Uint64 frame_trace = trace_begin();
+        Uint64 phase = trace_begin();
         while (SDL_PollEvent(&event)) {
             if (event.type == SDL_QUIT) {
                 running = 0;
             }
+            input_handle_event(&event);
+            trace_handle_event(&event);
         }
+        trace_end("input", phase);
 
-        const Uint8 *keys = SDL_GetKeyboardState(NULL);
-        if (!update_game(&game, keys)) { // Check for game over
+        Frame *frame = begin_frame(texture);
+        if (!frame) break;
+
+        // Simulate the next frame, in the background when pipelined
+        steps_to_run = timestep_advance(&step);
+        step_alpha = step.alpha;
+        if (pipelined) {
+            pipeline_start();
+        } else {
+            simulate(NULL);
+            front = !front;
+        }
+        const Snapshot *shown = &snapshots[front];
+        if (shown->over) { // Check for game over
             printf("You fell into a pit! Game Over.\n");
             SDL_Delay(1000); // Brief pause to see the fall
             running = 0;
         }
-        draw_game(&game, renderer);
 
-        SDL_Delay(16); // ~60 FPS
+        phase = trace_begin();
+        draw_game(&shown->game, shown->alpha, frame);
+        trace_end("render", phase);
+        end_frame(frame);
+
+        phase = trace_begin();
+        SDL_RenderClear(renderer);
+        SDL_RenderCopy(renderer, texture, NULL, NULL);
+        SDL_RenderPresent(renderer);
+        trace_end("present", phase);
+
+        // The simulated frame is the next one drawn
+        if (pipelined) {
+            pipeline_wait();
+            front = !front;
+        }
+
+        trace_end("frame", frame_trace);
+
+        if (!bench_frame_end()) running = 0; // Headless frame budget spent
+        timestep_throttle(&step);
     }
 
+    bench_report("PitfallClone");
+    bench_shutdown();
+    pipeline_shutdown();
+    trace_shutdown();
+    destroy_frame();
     SDL_DestroyTexture(texture);
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
@@ -2,6 +2,8 @@
 #define SCROLLER_H
 
 #include <SDL2/SDL.h>
+#include "frame.h"
+#include "rng.h"
 
 #define SCREEN_WIDTH 800
 #define SCREEN_HEIGHT 600
@@ -12,9 +14,11 @@
 // Player structure
 typedef struct {
     float x, y;         // Position (y for jumping)
-    float vel_x, vel_y; // Velocity
+    float prev_y;       // Previous tick, for render interpolation
+    float vel_x, vel_y; // Velocity in pixels per second
     int jumping;        // Jump state
     int frame;          // Animation frame
+    float anim_time;    // Seconds since the walk cycle last advanced
 } Player;
 
 // Pit structure
@@ -27,12 +31,15 @@ typedef struct {
 typedef struct {
     Player player;
     Pit pits[MAX_PITS];
-    int world_offset;   // Scrolling offset
-    SDL_Texture *texture;
+    float world_offset; // Scrolling offset
+    float prev_world_offset;
 } GameState;
 
-void init_game(GameState *game, SDL_Texture *texture);
-int update_game(GameState *game, const Uint8 *keys); // Changed from void to int
-void draw_game(GameState *game, SDL_Renderer *renderer);
+// Reset the player and lay out new pits from `rng`
+void init_game(GameState *game, Rng *rng);
+// Advance one tick of `dt` seconds; returns 0 on game over
+int update_game(GameState *game, const Uint8 *keys, float dt);
+// Draw blended `alpha` of the way from the previous tick to the current one
+void draw_game(const GameState *game, float alpha, Frame *frame);
 
 #endif
\ No newline at end of file
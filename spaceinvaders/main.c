@@ -1,14 +1,19 @@
 #include <SDL2/SDL.h>
+#include "frame.h"
+#include "blit.h"
+#include "bench.h"
+#include "trace.h"
+#include "input.h"
+#include "missiles.h"
+#include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 // Global screen dimensions
 const int SCREEN_WIDTH = 800;
 const int SCREEN_HEIGHT = 600;
 
-// Global pixel buffer and pitch
-Uint32 *pixels;
-int pitch;
-
 // Invader sprite (8x8)
 const Uint8 invader_sprite[8] = {
     0b00100100, //   *  *    (antennae)
@@ -33,14 +38,6 @@ const Uint8 ship_sprite[8] = {
     0b00111100  //   ****  
 };
 
-// Missile sprite (4x4)
-const Uint8 missile_sprite[4] = {
-    0b01100000, //  ** 
-    0b11110000, // ****
-    0b11110000, // ****
-    0b01100000  //  ** 
-};
-
 // Digit sprites (5x5, 0-9)
 const Uint8 digit_sprites[10][5] = {
     {0b11110, 0b10010, 0b10010, 0b10010, 0b11110}, // 0
@@ -55,27 +52,9 @@ const Uint8 digit_sprites[10][5] = {
     {0b11110, 0b10010, 0b11110, 0b00010, 0b11110}  // 9
 };
 
-// Draw sprite
-void draw_sprite(int x, int y, const Uint8 *sprite, int width, int height, Uint32 color, SDL_Texture *texture) {
-    SDL_LockTexture(texture, NULL, (void **)&pixels, &pitch);
-    int bytes_per_row = pitch / sizeof(Uint32);
-
-    for (int row = 0; row < height; row++) {
-        if (y + row < 0 || y + row >= SCREEN_HEIGHT) continue;
-        Uint8 bits = sprite[row];
-        for (int col = 0; col < width; col++) {
-            if (x + col < 0 || x + col >= SCREEN_WIDTH) continue;
-            if (bits & (1 << (7 - col))) {
-                pixels[(y + row) * bytes_per_row + (x + col)] = color;
-            }
-        }
-    }
-    SDL_UnlockTexture(texture);
-}
-
 // Move invader
-void move_invader(int *inv_x, int *inv_vel, int *inv_y, SDL_Texture *texture) {
-    draw_sprite(*inv_x, *inv_y, invader_sprite, 8, 8, 0x000000FF, texture);
+void move_invader(int *inv_x, int *inv_vel, int *inv_y, Frame *frame) {
+    draw_sprite(*inv_x, *inv_y, invader_sprite, 8, 8, 0x000000FF, frame);
     *inv_x += *inv_vel;
     if (*inv_x + 8 > SCREEN_WIDTH) {
         *inv_x = SCREEN_WIDTH - 8;
@@ -86,75 +65,68 @@ void move_invader(int *inv_x, int *inv_vel, int *inv_y, SDL_Texture *texture) {
         *inv_vel = 2;
         *inv_y += 8;
     }
-    draw_sprite(*inv_x, *inv_y, invader_sprite, 8, 8, 0x00FF00FF, texture);
+    draw_sprite(*inv_x, *inv_y, invader_sprite, 8, 8, 0x00FF00FF, frame);
 }
 
 // Draw score
-void draw_score(int score, SDL_Texture *texture) {
+void draw_score(int score, Frame *frame) {
     int x = 10, y = 10;
     char score_str[10];
     snprintf(score_str, 10, "%d", score);
     for (int i = 0; score_str[i]; i++) {
         int digit = score_str[i] - '0';
-        draw_sprite(x + i * 6, y, digit_sprites[digit], 5, 5, 0xFFFFFFFF, texture);
+        draw_sprite(x + i * 6, y, digit_sprites[digit], 5, 5, 0xFFFFFFFF, frame);
     }
 }
 
-// Struct for missiles
-typedef struct {
-    int x, y;
-    int active;
-    int friendly;
-} Missile;
-
-// Check collision between point and rectangle
-int check_collision(int x, int y, int rect_x, int rect_y, int rect_w, int rect_h) {
-    return (x >= rect_x && x < rect_x + rect_w && y >= rect_y && y < rect_y + rect_h);
-}
-
-int main(int argc, char *argv[]) {
-    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
-        printf("SDL Init failed: %s\n", SDL_GetError());
-        return 1;
-    }
-
-    SDL_Window *window = SDL_CreateWindow("Space Invaders",
-                                          SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
-                                          SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
-    if (!window) {
-        printf("Window creation failed: %s\n", SDL_GetError());
-        SDL_Quit();
-        return 1;
-    }
-
-    SDL_Renderer *renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
-    if (!renderer) {
-        printf("Renderer creation failed: %s\n", SDL_GetError());
-        SDL_DestroyWindow(window);
-        SDL_Quit();
-        return 1;
+// Missiles in flight; the classic game has room for 100
+#define CLASSIC_MISSILES 100
+static Missiles *missiles;
+
+// Bullet-hell mode (--bullet-hell N): the invaders fill the screen with
+// spirals of up to N bullets, drawn as small squares, and only the middle
+// of the ship can be hit
+static int bullet_hell;
+#define BULLET_SIZE 3
+#define BULLET_LIFETIME 128 // Frames a volley is sized to last, so the pool fills
+#define GOLDEN_ANGLE 2.39996323f
+
+// Take the game's own flags out of the arguments, leaving the rest for the bench
+static int parse_game_args(int *argc, char *argv[]) {
+    int kept = 1;
+    for (int i = 1; i < *argc; i++) {
+        if (strcmp(argv[i], "--bullet-hell") == 0 && i + 1 < *argc) {
+            bullet_hell = atoi(argv[++i]);
+            if (bullet_hell < 1 || bullet_hell > MISSILES_MAX_CAPACITY) {
+                printf("--bullet-hell takes 1 to %d\n", MISSILES_MAX_CAPACITY);
+                return 0;
+            }
+        } else {
+            argv[kept++] = argv[i];
+        }
     }
+    *argc = kept;
+    return 1;
+}
 
-    SDL_Texture *texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888,
-                                            SDL_TEXTUREACCESS_STREAMING,
-                                            SCREEN_WIDTH, SCREEN_HEIGHT);
-    if (!texture) {
-        printf("Texture creation failed: %s\n", SDL_GetError());
-        SDL_DestroyRenderer(renderer);
-        SDL_DestroyWindow(window);
-        SDL_Quit();
-        return 1;
-    }
+// Headless input: strafe back and forth, firing in bursts
+static const ScriptedKey input_script[] = {
+    {SDL_SCANCODE_LEFT, 80, 40, 0},
+    {SDL_SCANCODE_RIGHT, 80, 40, 40},
+    {SDL_SCANCODE_SPACE, 15, 2, 0},
+};
 
+// Play one round (until win or game over); returns 0 when the game should exit
+static int play_round(SDL_Renderer *renderer, SDL_Texture *texture) {
     // Clear screen
-    SDL_LockTexture(texture, NULL, (void **)&pixels, &pitch);
-    for (int i = 0; i < SCREEN_WIDTH * SCREEN_HEIGHT; i++) {
-        pixels[i] = 0x000000FF;
-    }
-    SDL_UnlockTexture(texture);
+    Frame *frame = begin_frame(texture);
+    if (!frame) return 0;
+    clear_frame(frame, 0x000000FF);
+    end_frame(frame);
 
     // Game state
     int running = 1;
+    int quit = 0;
     int ship_x = SCREEN_WIDTH / 2 - 4;
     int ship_y = SCREEN_HEIGHT - 16;
     int ship_vel = 0;
@@ -163,39 +135,52 @@ int main(int argc, char *argv[]) {
     int inv_vel[5] = {2, 2, 2, 2, 2};
     int inv_y[5] = {50, 50, 50, 50, 50};
     int inv_alive[5] = {1, 1, 1, 1, 1};
-    Missile missiles[100] = {0};
+    missiles_clear(missiles);
+    float spiral = 0.0f; // Bullet-hell volleys' next direction
     int score = 0;
     SDL_Event event;
-    Uint32 last_alien_shot = 0;
+    int frame_count = 0;
+    int last_alien_shot = 0;
 
     while (running) {
+        bench_frame_begin();
+        Uint64 frame_trace = trace_begin();
+
         // Input
+        Uint64 phase = trace_begin();
         while (SDL_PollEvent(&event)) {
             if (event.type == SDL_QUIT) {
                 running = 0;
-            } else if (event.type == SDL_KEYDOWN && ship_alive) {
-                switch (event.key.keysym.sym) {
-                    case SDLK_LEFT:
-                        ship_vel = -5;
-                        break;
-                    case SDLK_RIGHT:
-                        ship_vel = 5;
-                        break;
-                    case SDLK_SPACE:
-                        for (int i = 0; i < 100; i++) {
-                            if (!missiles[i].active) {
-                                missiles[i] = (Missile){ship_x + 2, ship_y - 4, 1, 1};
-                                break;
-                            }
-                        }
-                        break;
-                }
+                quit = 1;
             }
+            input_handle_event(&event);
+            trace_handle_event(&event);
         }
 
+        // Key presses, latched once per frame so they can be recorded and replayed
+        if (!input_tick()) { // Replay finished: nothing runs past its last frame
+            running = 0;
+            quit = 1;
+            break;
+        }
+        if (ship_alive) {
+            if (input_pressed(SDL_SCANCODE_LEFT)) ship_vel = -5;
+            if (input_pressed(SDL_SCANCODE_RIGHT)) ship_vel = 5;
+            if (input_pressed(SDL_SCANCODE_SPACE)) {
+                missiles_spawn(missiles, (float)(ship_x + 2), (float)(ship_y - 4), 0.0f, -50.0f, 1);
+            }
+        }
+        trace_end("input", phase);
+
+        // Updates draw as they go, so update and render share a phase
+        phase = trace_begin();
+        frame = begin_frame(texture);
+        if (!frame) return 0;
+        missiles_erase(missiles, frame);
+
         // Update ship
         if (ship_alive) {
-            draw_sprite(ship_x, ship_y, ship_sprite, 8, 8, 0x000000FF, texture);
+            draw_sprite(ship_x, ship_y, ship_sprite, 8, 8, 0x000000FF, frame);
             ship_x += ship_vel;
             if (ship_x < 0) ship_x = 0;
             if (ship_x + 8 > SCREEN_WIDTH) ship_x = SCREEN_WIDTH - 8;
@@ -205,7 +190,7 @@ int main(int argc, char *argv[]) {
         int invaders_left = 0;
         for (int i = 0; i < 5; i++) {
             if (inv_alive[i]) {
-                move_invader(&inv_x[i], &inv_vel[i], &inv_y[i], texture);
+                move_invader(&inv_x[i], &inv_vel[i], &inv_y[i], frame);
                 invaders_left++;
                 if (inv_y[i] >= SCREEN_HEIGHT - 8) {
                     ship_alive = 0;
@@ -213,99 +198,169 @@ int main(int argc, char *argv[]) {
             }
         }
 
-        // Alien shooting (every 2 sec)
-        Uint32 now = SDL_GetTicks();
-        if (now - last_alien_shot > 2000 && invaders_left > 0) {
+        // Alien shooting: one missile every 120 frames (~2 sec), or in
+        // bullet-hell mode a volley from every invader every frame, each
+        // bullet a golden angle round from the last
+        if (bullet_hell && invaders_left > 0) {
+            int volley = bullet_hell / BULLET_LIFETIME / invaders_left + 1;
+            for (int i = 0; i < 5; i++) {
+                if (!inv_alive[i]) continue;
+                for (int b = 0; b < volley; b++) {
+                    float speed = 2.0f + (b % 3);
+                    missiles_spawn(missiles, (float)(inv_x[i] + 3), (float)(inv_y[i] + 3),
+                                   sinf(spiral) * speed, cosf(spiral) * speed, 0);
+                    spiral = remainderf(spiral + GOLDEN_ANGLE, 2.0f * (float)M_PI);
+                }
+            }
+        } else if (frame_count - last_alien_shot > 120 && invaders_left > 0) {
             for (int i = 0; i < 5; i++) {
                 if (inv_alive[i]) {
-                    for (int j = 0; j < 100; j++) {
-                        if (!missiles[j].active) {
-                            missiles[j] = (Missile){inv_x[i] + 2, inv_y[i] + 8, 1, 0};
-                            break;
-                        }
-                    }
+                    missiles_spawn(missiles, (float)(inv_x[i] + 2), (float)(inv_y[i] + 8), 0.0f, 50.0f, 0);
                     break;
                 }
             }
-            last_alien_shot = now;
+            last_alien_shot = frame_count;
         }
 
-        // Update missiles with path collision
-        for (int i = 0; i < 100; i++) {
-            if (missiles[i].active) {
-                int old_y = missiles[i].y;
-                draw_sprite(missiles[i].x, old_y, missile_sprite, 4, 4, 0x000000FF, texture);
-                missiles[i].y += missiles[i].friendly ? -50 : 50;
-
-                // Check collision along path
-                int steps = 50; // Bullet moves 50 pixels
-                int step_y = (missiles[i].y - old_y) / steps;
-                int hit = 0;
-                for (int s = 0; s <= steps && !hit; s++) {
-                    int check_y = old_y + s * step_y;
-                    if (missiles[i].friendly) {
-                        for (int j = 0; j < 5 && !hit; j++) {
-                            if (inv_alive[j] && check_collision(missiles[i].x, check_y, inv_x[j], inv_y[j], 8, 8)) {
-                                inv_alive[j] = 0;
-                                missiles[i].active = 0;
-                                draw_sprite(inv_x[j], inv_y[j], invader_sprite, 8, 8, 0x000000FF, texture);
-                                score += 10;
-                                hit = 1;
-                            }
-                        }
-                    } else if (ship_alive && check_collision(missiles[i].x, check_y, ship_x, ship_y, 8, 8)) {
-                        ship_alive = 0;
-                        draw_sprite(ship_x, ship_y, ship_sprite, 8, 8, 0x000000FF, texture);
-                        hit = 1;
+        // Update missiles, each swept along its whole move: a friendly one
+        // takes out the first invader on its way, a hostile one the ship
+        Uint64 missile_phase = trace_begin();
+        int hit_x = bullet_hell ? 2 : 0, hit_size = bullet_hell ? 4 : 8; // Ship's hitbox
+        for (int i = 0; i < missiles->count;) {
+            int hit = 0;
+            if (missiles->friendly[i]) {
+                int target = -1;
+                float first = 2.0f;
+                for (int j = 0; j < 5; j++) {
+                    if (!inv_alive[j]) continue;
+                    float t = missiles_sweep(missiles, i, inv_x[j], inv_y[j], 8, 8);
+                    if (t >= 0.0f && t < first) {
+                        first = t;
+                        target = j;
                     }
                 }
-
-                if (missiles[i].y < 0 || missiles[i].y >= SCREEN_HEIGHT) {
-                    missiles[i].active = 0;
-                } else if (!hit) {
-                    Uint32 color = missiles[i].friendly ? 0xFFFFFF00 : 0xFF0000FF;
-                    draw_sprite(missiles[i].x, missiles[i].y, missile_sprite, 4, 4, color, texture);
+                if (target >= 0) {
+                    inv_alive[target] = 0;
+                    draw_sprite(inv_x[target], inv_y[target], invader_sprite, 8, 8, 0x000000FF, frame);
+                    score += 10;
+                    hit = 1;
                 }
+            } else if (ship_alive && missiles_sweep(missiles, i, ship_x + hit_x, ship_y + hit_x, hit_size, hit_size) >= 0.0f) {
+                ship_alive = 0;
+                draw_sprite(ship_x, ship_y, ship_sprite, 8, 8, 0x000000FF, frame);
+                hit = 1;
             }
-        }
 
-        // Compact missiles
-        int new_count = 0;
-        for (int i = 0; i < 100; i++) {
-            if (missiles[i].active) {
-                missiles[new_count] = missiles[i];
-                new_count++;
+            float x = missiles->x[i] += missiles->vel_x[i];
+            float y = missiles->y[i] += missiles->vel_y[i];
+            if (hit || x < 0 || x >= SCREEN_WIDTH || y < 0 || y >= SCREEN_HEIGHT) {
+                missiles_remove(missiles, i); // The last one moves here, still to update
+            } else {
+                i++;
             }
         }
-        for (int i = new_count; i < 100; i++) {
-            missiles[i].active = 0;
-        }
+        missiles_draw(missiles, frame);
+        trace_end("missiles", missile_phase);
 
         // Draw ship if alive
         if (ship_alive) {
-            draw_sprite(ship_x, ship_y, ship_sprite, 8, 8, 0x0000FFFF, texture);
+            draw_sprite(ship_x, ship_y, ship_sprite, 8, 8, 0x0000FFFF, frame);
         }
 
         // Draw score
-        draw_score(score, texture);
+        draw_score(score, frame);
+        trace_end("update", phase);
+        end_frame(frame);
 
         // Win/lose
         if (invaders_left == 0) {
-            printf("You Win! Score: %d\n", score);
+            if (!bench_is_headless()) printf("You Win! Score: %d\n", score);
             running = 0;
         } else if (!ship_alive) {
-            printf("Game Over! Score: %d\n", score);
+            if (!bench_is_headless()) printf("Game Over! Score: %d\n", score);
             running = 0;
         }
 
         // Render
+        phase = trace_begin();
         SDL_RenderClear(renderer);
         SDL_RenderCopy(renderer, texture, NULL, NULL);
         SDL_RenderPresent(renderer);
+        trace_end("present", phase);
+
+        frame_count++;
+        trace_end("frame", frame_trace);
+        if (!bench_frame_end()) {
+            running = 0; // Headless frame budget spent
+            quit = 1;
+        }
+        bench_delay(16); // ~60 FPS
+    }
+    return !quit;
+}
+
+
+int main(int argc, char *argv[]) {
+    BenchOptions options = {.seed = 1};
+    if (!parse_game_args(&argc, argv) || !bench_parse_args(argc, argv, &options) ||
+        !bench_init(&options, input_script, SDL_arraysize(input_script))) {
+        return 1;
+    }
+
+    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+        printf("SDL Init failed: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    SDL_Window *window = SDL_CreateWindow("Space Invaders",
+                                          SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+                                          SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
+    if (!window) {
+        printf("Window creation failed: %s\n", SDL_GetError());
+        SDL_Quit();
+        return 1;
+    }
+
+    SDL_Renderer *renderer = SDL_CreateRenderer(window, -1, bench_renderer_flags());
+    if (!renderer) {
+        printf("Renderer creation failed: %s\n", SDL_GetError());
+        SDL_DestroyWindow(window);
+        SDL_Quit();
+        return 1;
+    }
+
+    SDL_Texture *texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888,
+                                            SDL_TEXTUREACCESS_STREAMING,
+                                            SCREEN_WIDTH, SCREEN_HEIGHT);
+    if (!texture) {
+        printf("Texture creation failed: %s\n", SDL_GetError());
+        SDL_DestroyRenderer(renderer);
+        SDL_DestroyWindow(window);
+        SDL_Quit();
+        return 1;
+    }
+
+    missiles = bullet_hell ? missiles_create(bullet_hell, BULLET_SIZE) : missiles_create(CLASSIC_MISSILES, 0);
+    if (!missiles) {
+        SDL_DestroyTexture(texture);
+        SDL_DestroyRenderer(renderer);
+        SDL_DestroyWindow(window);
+        SDL_Quit();
+        return 1;
+    }
+
+    // Phase timings; F12 or exit writes them out (tracing is skipped if allocation fails)
+    trace_init("spaceinvaders_trace.json");
 
-        SDL_Delay(16); // ~60 FPS
+    // Headless runs start a new round whenever one ends, until the frame budget is spent
+    while (play_round(renderer, texture) && bench_is_headless()) {
     }
 
+    bench_report("HelloPixels");
+    bench_shutdown();
+    trace_shutdown();
+    destroy_frame();
+    missiles_destroy(missiles);
     SDL_DestroyTexture(texture);
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
@@ -0,0 +1,129 @@
+#include "missiles.h"
+#include "blit.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BACKGROUND_COLOR 0x000000FF
+#define FRIENDLY_COLOR 0xFFFFFF00
+#define HOSTILE_COLOR 0xFF0000FF
+
+// Missile sprite (4x4)
+static const Uint8 missile_sprite[4] = {
+    0b01100000, //  ** 
+    0b11110000, // ****
+    0b11110000, // ****
+    0b01100000  //  ** 
+};
+
+Missiles *missiles_create(int capacity, int point_size) {
+    if (capacity < 1 || capacity > MISSILES_MAX_CAPACITY) {
+        printf("Missile pools hold 1 to %d missiles\n", MISSILES_MAX_CAPACITY);
+        return NULL;
+    }
+    Missiles *missiles = calloc(1, sizeof(Missiles));
+    if (!missiles) return NULL;
+    missiles->capacity = capacity;
+    missiles->point_size = point_size;
+
+    // One block holding every field
+    size_t n = (size_t)capacity;
+    char *block = calloc(n, 4 * sizeof(float) + 1 + 2 * (2 * sizeof(int) + sizeof(Uint32)) + sizeof(Uint32));
+    if (!block) {
+        printf("Missile pool allocation failed (%d missiles)\n", capacity);
+        free(missiles);
+        return NULL;
+    }
+    missiles->x = (float *)block;
+    missiles->y = missiles->x + n;
+    missiles->vel_x = missiles->y + n;
+    missiles->vel_y = missiles->vel_x + n;
+    missiles->drawn_x = (int *)(missiles->vel_y + n);
+    missiles->drawn_y = missiles->drawn_x + n;
+    missiles->spare_x = missiles->drawn_y + n;
+    missiles->spare_y = missiles->spare_x + n;
+    missiles->drawn_color = (Uint32 *)(missiles->spare_y + n);
+    missiles->spare_color = missiles->drawn_color + n;
+    missiles->background = missiles->spare_color + n;
+    missiles->friendly = (Uint8 *)(missiles->background + n);
+    for (int i = 0; i < capacity; i++) missiles->background[i] = BACKGROUND_COLOR;
+    return missiles;
+}
+
+void missiles_destroy(Missiles *missiles) {
+    if (!missiles) return;
+    free(missiles->x); // The block
+    free(missiles);
+}
+
+void missiles_clear(Missiles *missiles) {
+    missiles->count = 0;
+    missiles->drawn_count = 0;
+}
+
+int missiles_spawn(Missiles *missiles, float x, float y, float vel_x, float vel_y, int friendly) {
+    if (missiles->count == missiles->capacity) return 0;
+    int i = missiles->count++;
+    missiles->x[i] = x;
+    missiles->y[i] = y;
+    missiles->vel_x[i] = vel_x;
+    missiles->vel_y[i] = vel_y;
+    missiles->friendly[i] = (Uint8)(friendly != 0);
+    return 1;
+}
+
+// Narrow the part [*t0, *t1] of the move p + d * t that lies in [lo, hi];
+// returns 0 once it's empty
+static int clip_axis(float p, float d, float lo, float hi, float *t0, float *t1) {
+    if (d == 0.0f) return p >= lo && p <= hi;
+    float a = (lo - p) / d, b = (hi - p) / d;
+    if (a > b) {
+        float swap = a;
+        a = b;
+        b = swap;
+    }
+    if (a > *t0) *t0 = a;
+    if (b < *t1) *t1 = b;
+    return *t0 <= *t1;
+}
+
+float missiles_sweep(const Missiles *missiles, int i, int x, int y, int w, int h) {
+    // The rectangle's pixels, so a move ending on its last row still counts
+    float t0 = 0.0f, t1 = 1.0f;
+    if (!clip_axis(missiles->x[i], missiles->vel_x[i], (float)x, (float)(x + w - 1), &t0, &t1)) return -1.0f;
+    if (!clip_axis(missiles->y[i], missiles->vel_y[i], (float)y, (float)(y + h - 1), &t0, &t1)) return -1.0f;
+    return t0;
+}
+
+void missiles_erase(Missiles *missiles, Frame *frame) {
+    if (missiles->point_size > 0) {
+        draw_points(0, 0, missiles->drawn_x, missiles->drawn_y, missiles->background, missiles->drawn_count,
+                    missiles->point_size, frame);
+        return;
+    }
+    for (int i = 0; i < missiles->drawn_count; i++) {
+        draw_sprite(missiles->drawn_x[i], missiles->drawn_y[i], missile_sprite, 4, 4, BACKGROUND_COLOR, frame);
+    }
+}
+
+void missiles_draw(Missiles *missiles, Frame *frame) {
+    // Into the spare arrays: the erase may still be reading the drawn ones
+    int *xs = missiles->spare_x, *ys = missiles->spare_y;
+    Uint32 *colors = missiles->spare_color;
+    for (int i = 0; i < missiles->count; i++) {
+        xs[i] = (int)missiles->x[i];
+        ys[i] = (int)missiles->y[i];
+        colors[i] = missiles->friendly[i] ? FRIENDLY_COLOR : HOSTILE_COLOR;
+    }
+    if (missiles->point_size > 0) {
+        draw_points(0, 0, xs, ys, colors, missiles->count, missiles->point_size, frame);
+    } else {
+        for (int i = 0; i < missiles->count; i++) draw_sprite(xs[i], ys[i], missile_sprite, 4, 4, colors[i], frame);
+    }
+    missiles->spare_x = missiles->drawn_x;
+    missiles->spare_y = missiles->drawn_y;
+    missiles->spare_color = missiles->drawn_color;
+    missiles->drawn_x = xs;
+    missiles->drawn_y = ys;
+    missiles->drawn_color = colors;
+    missiles->drawn_count = missiles->count;
+}
\ No newline at end of file
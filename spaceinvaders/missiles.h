@@ -0,0 +1,52 @@
+#ifndef MISSILES_H
+#define MISSILES_H
+
+#include <SDL2/SDL.h>
+#include "frame.h"
+
+// Largest pool a round can have (bullet-hell mode)
+#define MISSILES_MAX_CAPACITY 100000
+
+// Missiles in flight. Live ones are always packed into [0, count), one
+// array per field: spawning appends and removing moves the last one into
+// the hole, both O(1), so a frame's work follows the live missiles and
+// never the capacity
+typedef struct {
+    int capacity, count;
+    float *x, *y;         // Top-left, px
+    float *vel_x, *vel_y; // px per frame
+    Uint8 *friendly;      // Fired by the ship (else by an invader)
+    int point_size;       // Drawn as squares this big in one batch, or 0 for the missile sprite
+    // Squares as drawn last frame, and the frame before (so a frame can
+    // erase the old ones and draw the new before either is rasterized)
+    int *drawn_x, *drawn_y, *spare_x, *spare_y;
+    Uint32 *drawn_color, *spare_color;
+    int drawn_count;
+    Uint32 *background; // capacity copies of the background color, for erasing
+} Missiles;
+
+// Make a pool for `capacity` missiles drawn as point_size squares (0 for
+// sprites); returns NULL on failure
+Missiles *missiles_create(int capacity, int point_size);
+void missiles_destroy(Missiles *missiles);
+// Drop every missile (without erasing them)
+void missiles_clear(Missiles *missiles);
+// Add one; returns 0 (and drops it) when the pool is full
+int missiles_spawn(Missiles *missiles, float x, float y, float vel_x, float vel_y, int friendly);
+// Remove missile i; the last one takes its place
+static inline void missiles_remove(Missiles *missiles, int i) {
+    int last = --missiles->count;
+    missiles->x[i] = missiles->x[last];
+    missiles->y[i] = missiles->y[last];
+    missiles->vel_x[i] = missiles->vel_x[last];
+    missiles->vel_y[i] = missiles->vel_y[last];
+    missiles->friendly[i] = missiles->friendly[last];
+}
+// Fraction of this frame's move at which missile i's top-left first enters
+// the w x h rectangle at (x, y), or -1 if it never does
+float missiles_sweep(const Missiles *missiles, int i, int x, int y, int w, int h);
+// Paint over the missiles as last drawn, then draw them where they are now
+void missiles_erase(Missiles *missiles, Frame *frame);
+void missiles_draw(Missiles *missiles, Frame *frame);
+
+#endif // MISSILES_H
\ No newline at end of file
@@ -1,144 +1,497 @@
 #include <SDL2/SDL.h>
 #include "cave.h"
+#include "frame.h"
+#include "rng.h"
+#include "hash.h"
 #include <stdio.h>
 #include <stdlib.h>
 
-// External globals from main.c
-extern Uint32 *pixels;
-extern int pitch;
-
-// Terrain buffer and scroll offset
-int top_terrain[TERRAIN_WIDTH];
-int bottom_terrain[TERRAIN_WIDTH];
-static float scroll_offset = 0.0f;
-static const float SCROLL_SPEED = 25.0f; // Pixels per second
-
-// Fuel pod array
-static FuelPod fuel_pods[MAX_FUEL_PODS];
-static int fuel_pod_count = 0;
-
-// Draw cave terrain and fuel pods
-static void draw_cave(SDL_Texture *texture) {
-    SDL_LockTexture(texture, NULL, (void **)&pixels, &pitch);
-    int bytes_per_row = pitch / sizeof(Uint32);
-
-    // Clear screen
-    for (int y = 0; y < SCREEN_HEIGHT; y++) {
-        for (int x = 0; x < SCREEN_WIDTH; x++) {
-            pixels[y * bytes_per_row + x] = 0x000000FF; // Black space
-        }
+// Fuel pods are indexed by world x in buckets of POD_BUCKET_WIDTH columns,
+// so drawing and collision only look at the buckets they overlap. Pods are
+// at least FUEL_POD_MIN_SPACING apart, which bounds a bucket's size. Pods in
+// a bucket are unordered: taking one moves the last into its place
+#define FUEL_POD_MIN_SPACING 8
+#define FUEL_POD_CHANCE 12 // One in this many columns past the spacing gets a pod
+#define POD_BUCKET_WIDTH 32
+#define POD_BUCKET_PODS (POD_BUCKET_WIDTH / FUEL_POD_MIN_SPACING)
+#define CHUNK_BUCKETS (CAVE_CHUNK_WIDTH / POD_BUCKET_WIDTH)
+
+typedef struct {
+    FuelPod pods[POD_BUCKET_PODS];
+    int count;
+} PodBucket;
+
+// Sparse tables of each chunk's columns: top[k][i] is the lowest ceiling
+// (max top) and bottom[k][i] the highest floor (min bottom) over columns
+// [i, i + 2^k), so any range of columns in a chunk is two overlapping lookups.
+// Screen rows fit in 16 bits, which halves a cave's footprint
+#define CHUNK_LEVELS 9 // 2^8 = CAVE_CHUNK_WIDTH
+
+// Columns and pods of one chunk of cave
+typedef struct {
+    Sint16 top[CHUNK_LEVELS][CAVE_CHUNK_WIDTH];
+    Sint16 bottom[CHUNK_LEVELS][CAVE_CHUNK_WIDTH];
+    PodBucket buckets[CHUNK_BUCKETS];
+} CaveChunk;
+
+// Random walk that carries on from one chunk to the next. The worker owns
+// it while running; cave_init owns it in between
+typedef struct {
+    Rng rng;
+    int last_top, last_bottom;
+    Sint64 next_pod_x; // First column the next pod may go in
+    int next_chunk;
+} Generator;
+
+// A snapshot covers every bucket between the previous tick's view and the
+// current one's (a frame scrolls at most a few pixels)
+#if (SCREEN_WIDTH / POD_BUCKET_WIDTH + 3) * POD_BUCKET_PODS > CAVE_SNAPSHOT_PODS
+#error CAVE_SNAPSHOT_PODS is too small for the screen
+#endif
+#if (SCREEN_WIDTH + CAVE_ROLLBACK_COLUMNS) / POD_BUCKET_WIDTH + 3 > CAVE_STATE_BUCKETS || \
+    CAVE_STATE_BUCKETS * POD_BUCKET_PODS > CAVE_STATE_PODS
+#error CaveState is too small for the screen
+#endif
+
+struct Cave {
+    // Chunk n lives in ring[n % chunks]. The view owns chunks
+    // [first_chunk, ready_chunks) and only reads them; the generator fills
+    // chunks from ready_chunks up to first_chunk + chunks. Chunk numbers are
+    // ints: 2^31 chunks is centuries of scrolling
+    CaveChunk *ring;
+    int chunks;
+    SDL_atomic_t first_chunk, ready_chunks;
+    Generator gen;
+    int background;       // Generate on the worker thread
+    SDL_Thread *worker;
+    SDL_sem *wake;        // Posted when the view frees a chunk
+    SDL_atomic_t worker_quit;
+    int view_first;       // first_chunk as last set by the view
+    int ready;            // ready_chunks as last seen by the view
+    int stalls;           // Ticks the view caught up with the generator
+
+    // Scroll offset in world pixels (a double stays exact for longer than anyone plays)
+    double scroll_offset;
+    double prev_scroll_offset; // Previous tick, for render interpolation
+
+    // Seeds each round's generator (seeded once, so replays rebuild the same caves)
+    Rng rng;
+
+    // Oldest column a frame being drawn may read (set by cave_hold between ticks)
+    Sint64 held_offset;
+
+    // What the frame holds: terrain scrolled to drawn_offset, plus the pods
+    // drawn last frame (erased before the next scroll)
+    Sint64 drawn_offset;
+    int drawn_valid; // 0 when the frame needs a full redraw
+    SDL_Rect drawn_pods[CAVE_SNAPSHOT_PODS];
+    int drawn_pod_count;
+};
+
+static CaveChunk *chunk_at(const Cave *cave, Sint64 world_x) {
+    return &cave->ring[(int)(world_x / CAVE_CHUNK_WIDTH) % cave->chunks];
+}
+
+// Bucket n covers world columns [n * POD_BUCKET_WIDTH, (n + 1) * POD_BUCKET_WIDTH)
+static PodBucket *bucket_at(const Cave *cave, Sint64 bucket) {
+    return &cave->ring[(int)(bucket / CHUNK_BUCKETS) % cave->chunks].buckets[bucket % CHUNK_BUCKETS];
+}
+
+int cave_top(const Cave *cave, Sint64 world_x) {
+    return chunk_at(cave, world_x)->top[0][world_x % CAVE_CHUNK_WIDTH];
+}
+
+int cave_bottom(const Cave *cave, Sint64 world_x) {
+    return chunk_at(cave, world_x)->bottom[0][world_x % CAVE_CHUNK_WIDTH];
+}
+
+void cave_range(const Cave *cave, Sint64 first, Sint64 last, int *max_top, int *min_bottom) {
+    int top = 0, bottom = SCREEN_HEIGHT;
+    while (first <= last) {
+        // The part of the range in this chunk
+        const CaveChunk *chunk = chunk_at(cave, first);
+        int i = (int)(first % CAVE_CHUNK_WIDTH);
+        int j = last / CAVE_CHUNK_WIDTH == first / CAVE_CHUNK_WIDTH ? (int)(last % CAVE_CHUNK_WIDTH) : CAVE_CHUNK_WIDTH - 1;
+        int k = SDL_MostSignificantBitIndex32((Uint32)(j - i + 1)); // Largest k with 2^k <= the width
+        int i2 = j - (1 << k) + 1; // Second window ends at j
+        if (chunk->top[k][i] > top) top = chunk->top[k][i];
+        if (chunk->top[k][i2] > top) top = chunk->top[k][i2];
+        if (chunk->bottom[k][i] < bottom) bottom = chunk->bottom[k][i];
+        if (chunk->bottom[k][i2] < bottom) bottom = chunk->bottom[k][i2];
+        first += j - i + 1;
+    }
+    *max_top = top;
+    *min_bottom = bottom;
+}
+
+int cave_sweep_hits(const Cave *cave, Sint64 x0, int y0, Sint64 x1, int y1, int w, int h) {
+    // Walk the path a pixel at a time (usually one step per tick), testing
+    // the box covering each step against every column under it
+    Sint64 dx = x1 - x0;
+    int dy = y1 - y0;
+    Sint64 steps = dx < 0 ? -dx : dx;
+    if (abs(dy) > steps) steps = abs(dy);
+    if (steps == 0) steps = 1;
+    Sint64 from_x = x0;
+    int from_y = y0;
+    for (Sint64 s = 1; s <= steps; s++) {
+        Sint64 to_x = x0 + dx * s / steps;
+        int to_y = y0 + (int)(dy * s / steps);
+        int top, bottom;
+        cave_range(cave, from_x < to_x ? from_x : to_x, (from_x > to_x ? from_x : to_x) + w - 1, &top, &bottom);
+        if ((from_y < to_y ? from_y : to_y) < top || (from_y > to_y ? from_y : to_y) + h > bottom) return 1;
+        from_x = to_x;
+        from_y = to_y;
     }
+    return 0;
+}
 
-    // Draw terrain with offset
-    int offset = (int)scroll_offset;
-    for (int x = 0; x < SCREEN_WIDTH; x++) {
-        int terrain_x = (x + offset) % TERRAIN_WIDTH;
-        for (int y = 0; y < top_terrain[terrain_x]; y++) {
-            pixels[y * bytes_per_row + x] = 0x808080FF; // Gray cave top
-        }
-        for (int y = bottom_terrain[terrain_x]; y < SCREEN_HEIGHT; y++) {
-            pixels[y * bytes_per_row + x] = 0x808080FF; // Gray cave bottom
-        }
+// Rasterize terrain at drawn_offset into a screen rectangle
+static void draw_terrain(const Cave *cave, Frame *frame, int x, int y, int w, int h) {
+    int x0 = x < 0 ? 0 : x;
+    int x1 = x + w > SCREEN_WIDTH ? SCREEN_WIDTH : x + w;
+    if (x0 >= x1) return;
+
+    // Black space, then the gray ceiling and floor over it
+    int top[SCREEN_WIDTH], bottom[SCREEN_WIDTH];
+    for (int px = x0; px < x1; px++) {
+        top[px - x0] = cave_top(cave, cave->drawn_offset + px);
+        bottom[px - x0] = cave_bottom(cave, cave->drawn_offset + px);
     }
+    fill_rect(frame, x0, y, x1 - x0, h, 0x000000FF);
+    fill_columns(frame, x0, y, x1 - x0, h, NULL, top, 0x808080FF);
+    fill_columns(frame, x0, y, x1 - x0, h, bottom, NULL, 0x808080FF);
+}
 
-    // Draw fuel pods
-    for (int i = 0; i < fuel_pod_count; i++) {
-        if (fuel_pods[i].active) {
-            int pod_x = (int)(fuel_pods[i].x - scroll_offset);
-            int pod_y = (int)fuel_pods[i].y;
-            if (pod_x >= 0 && pod_x < SCREEN_WIDTH - 4) {
-                for (int y = pod_y; y < pod_y + 4; y++) {
-                    for (int x = pod_x; x < pod_x + 4; x++) {
-                        if (x >= 0 && x < SCREEN_WIDTH && y >= 0 && y < SCREEN_HEIGHT) {
-                            pixels[y * bytes_per_row + x] = 0xFFFF00FF; // Yellow fuel pod
-                        }
-                    }
-                }
-            }
+// Bring the frame's terrain to `scroll`: shift what's there by the whole
+// pixels scrolled and rasterize only the columns that came into view
+static void draw_cave(Cave *cave, Frame *frame, const CaveSnapshot *snap, double scroll) {
+    // Pods move with the terrain but aren't part of it
+    for (int i = 0; i < cave->drawn_pod_count; i++) {
+        const SDL_Rect *pod = &cave->drawn_pods[i];
+        cave_restore(cave, frame, pod->x, pod->y, pod->w, pod->h);
+    }
+    cave->drawn_pod_count = 0;
+
+    Sint64 offset = (Sint64)scroll;
+    Sint64 delta = cave->drawn_valid ? offset - cave->drawn_offset : SCREEN_WIDTH;
+    cave->drawn_offset = offset;
+    cave->drawn_valid = 1;
+    if (delta >= SCREEN_WIDTH) {
+        draw_terrain(cave, frame, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+    } else if (delta > 0) {
+        int shift = (int)delta;
+        shift_rows_left(frame, 0, SCREEN_HEIGHT, shift);
+        draw_terrain(cave, frame, SCREEN_WIDTH - shift, 0, shift, SCREEN_HEIGHT);
+    }
+
+    // Draw the fuel pods on screen
+    for (int i = 0; i < snap->pod_count; i++) {
+        int pod_x = (int)(snap->pods[i].x - offset);
+        int pod_y = snap->pods[i].y;
+        if (pod_x >= 0 && pod_x < SCREEN_WIDTH - 4) {
+            fill_rect(frame, pod_x, pod_y, 4, 4, 0xFFFF00FF); // Yellow fuel pod
+            cave->drawn_pods[cave->drawn_pod_count++] = (SDL_Rect){pod_x, pod_y, 4, 4};
         }
     }
-    SDL_UnlockTexture(texture);
 }
 
-// Generate procedural terrain with seamless loop and more variance
-static void generate_terrain() {
-    int start_top = SCREEN_HEIGHT / 3;
-    int start_bottom = SCREEN_HEIGHT - SCREEN_HEIGHT / 3;
-    int last_top = start_top;
-    int last_bottom = start_bottom;
+// Generate the next chunk of terrain with more variance, into its ring slot
+static void generate_chunk(Cave *cave, Generator *g) {
+    CaveChunk *chunk = &cave->ring[g->next_chunk % cave->chunks];
+    Sint64 start_x = (Sint64)g->next_chunk * CAVE_CHUNK_WIDTH;
+    for (int b = 0; b < CHUNK_BUCKETS; b++) chunk->buckets[b].count = 0;
+
+    for (int col = 0; col < CAVE_CHUNK_WIDTH; col++) {
+        Sint64 x = start_x + col;
 
-    for (int x = 0; x < TERRAIN_WIDTH; x++) {
         // Increased variance
-        last_top += (rand() % 31) - 15; // -15 to +15
-        last_bottom += (rand() % 31) - 15;
+        g->last_top += rng_range(&g->rng, 31) - 15; // -15 to +15
+        g->last_bottom += rng_range(&g->rng, 31) - 15;
 
         // Choke points and open areas (every ~150 pixels)
         if (x % 150 < 30) {
-            int gap = (rand() % 2 == 0) ? 100 + (rand() % 51) : 300 + (rand() % 201); // 100-150 or 300-500
-            last_bottom = last_top + gap;
+            int gap = (rng_range(&g->rng, 2) == 0) ? 100 + rng_range(&g->rng, 51) : 300 + rng_range(&g->rng, 201); // 100-150 or 300-500
+            g->last_bottom = g->last_top + gap;
         }
 
         // Bounds for wider cave
-        if (last_top < 50) last_top = 50;
-        if (last_top > SCREEN_HEIGHT / 2 - 50) last_top = SCREEN_HEIGHT / 2 - 50;
-        if (last_bottom < SCREEN_HEIGHT / 2 + 50) last_bottom = SCREEN_HEIGHT / 2 + 50;
-        if (last_bottom > SCREEN_HEIGHT - 50) last_bottom = SCREEN_HEIGHT - 50;
-        if (last_bottom - last_top < 100) last_bottom = last_top + 100; // Min gap widened
-
-        top_terrain[x] = last_top;
-        bottom_terrain[x] = last_bottom;
-
-        // Spawn fuel pods every ~500 pixels
-        if (x % 500 == 0 && fuel_pod_count < MAX_FUEL_PODS) {
-            fuel_pods[fuel_pod_count].x = (float)x;
-            fuel_pods[fuel_pod_count].y = (float)(last_top + (last_bottom - last_top) / 2); // Middle of gap
-            fuel_pods[fuel_pod_count].active = 1;
-            fuel_pod_count++;
+        if (g->last_top < 50) g->last_top = 50;
+        if (g->last_top > SCREEN_HEIGHT / 2 - 50) g->last_top = SCREEN_HEIGHT / 2 - 50;
+        if (g->last_bottom < SCREEN_HEIGHT / 2 + 50) g->last_bottom = SCREEN_HEIGHT / 2 + 50;
+        if (g->last_bottom > SCREEN_HEIGHT - 50) g->last_bottom = SCREEN_HEIGHT - 50;
+        if (g->last_bottom - g->last_top < 100) g->last_bottom = g->last_top + 100; // Min gap widened
+
+        chunk->top[0][col] = (Sint16)g->last_top;
+        chunk->bottom[0][col] = (Sint16)g->last_bottom;
+
+        // Scatter fuel pods through the gap
+        PodBucket *bucket = &chunk->buckets[col / POD_BUCKET_WIDTH];
+        if (x >= g->next_pod_x && rng_range(&g->rng, FUEL_POD_CHANCE) == 0 && bucket->count < POD_BUCKET_PODS) {
+            FuelPod *pod = &bucket->pods[bucket->count++];
+            pod->x = x;
+            pod->y = g->last_top + 10 + rng_range(&g->rng, g->last_bottom - g->last_top - 24); // Clear of both walls
+            g->next_pod_x = x + FUEL_POD_MIN_SPACING;
+        }
+    }
+
+    // Each level combines two windows of the one below
+    for (int k = 1; k < CHUNK_LEVELS; k++) {
+        int half = 1 << (k - 1);
+        for (int i = 0; i + 2 * half <= CAVE_CHUNK_WIDTH; i++) {
+            int a = chunk->top[k - 1][i], b = chunk->top[k - 1][i + half];
+            chunk->top[k][i] = a > b ? a : b;
+            a = chunk->bottom[k - 1][i];
+            b = chunk->bottom[k - 1][i + half];
+            chunk->bottom[k][i] = a < b ? a : b;
         }
+    }
+    g->next_chunk++;
+}
 
-        // Seamless loop
-        if (x == TERRAIN_WIDTH - 1) {
-            top_terrain[x] = start_top;
-            bottom_terrain[x] = start_bottom;
+// Worker: keep the ring full, sleeping while the view has every slot
+static int SDLCALL generate_ahead(void *data) {
+    Cave *cave = data;
+    Generator *gen = &cave->gen;
+    while (!SDL_AtomicGet(&cave->worker_quit)) {
+        int first = SDL_AtomicGet(&cave->first_chunk);
+        SDL_MemoryBarrierAcquire(); // The view is done with the chunks before `first`
+        if (gen->next_chunk < first + cave->chunks) {
+            generate_chunk(cave, gen);
+            SDL_MemoryBarrierRelease(); // Chunk contents before the count
+            SDL_AtomicSet(&cave->ready_chunks, gen->next_chunk);
+        } else {
+            SDL_SemWait(cave->wake);
         }
     }
+    return 0;
+}
+
+static void stop_worker(Cave *cave) {
+    if (!cave->worker) return;
+    SDL_AtomicSet(&cave->worker_quit, 1);
+    SDL_SemPost(cave->wake);
+    SDL_WaitThread(cave->worker, NULL);
+    cave->worker = NULL;
+    SDL_AtomicSet(&cave->worker_quit, 0);
+}
+
+Cave *cave_create(unsigned int seed, int chunks, int background) {
+    if (chunks < CAVE_MIN_CHUNKS) {
+        printf("A cave needs at least %d chunks\n", CAVE_MIN_CHUNKS);
+        return NULL;
+    }
+    Cave *cave = calloc(1, sizeof(Cave));
+    CaveChunk *ring = calloc(chunks, sizeof(CaveChunk));
+    if (!cave || !ring) {
+        printf("Out of memory for the cave\n");
+        free(cave);
+        free(ring);
+        return NULL;
+    }
+    cave->ring = ring;
+    cave->chunks = chunks;
+    cave->background = background;
+    rng_seed(&cave->rng, seed);
+    return cave;
+}
+
+void cave_destroy(Cave *cave) {
+    if (!cave) return;
+    stop_worker(cave);
+    if (cave->wake) SDL_DestroySemaphore(cave->wake);
+    if (cave->stalls) printf("Cave generator fell behind for %d ticks\n", cave->stalls);
+    free(cave->ring);
+    free(cave);
+}
+
+void cave_init(Cave *cave, Frame *frame) {
+    stop_worker(cave);
+
+    // Every round is a new cave, the same ones in the same order for a seed
+    Generator *gen = &cave->gen;
+    rng_seed(&gen->rng, rng_next(&cave->rng));
+    gen->last_top = SCREEN_HEIGHT / 3;
+    gen->last_bottom = SCREEN_HEIGHT - SCREEN_HEIGHT / 3;
+    gen->next_pod_x = 0;
+    gen->next_chunk = 0;
+    cave->scroll_offset = 0.0;
+    cave->prev_scroll_offset = 0.0;
+    cave->held_offset = frame ? 0 : SDL_MAX_SINT64; // A cave that's never drawn holds nothing
+
+    // Fill the ring here so the round starts without waiting on the worker
+    while (gen->next_chunk < cave->chunks) generate_chunk(cave, gen);
+    cave->view_first = 0;
+    SDL_AtomicSet(&cave->first_chunk, 0);
+    SDL_AtomicSet(&cave->ready_chunks, gen->next_chunk);
+    cave->ready = gen->next_chunk;
+
+    if (cave->background) {
+        if (!cave->wake) cave->wake = SDL_CreateSemaphore(0);
+        cave->worker = cave->wake ? SDL_CreateThread(generate_ahead, "cave", cave) : NULL;
+        if (!cave->worker) printf("Cave generator thread failed, generating on the main thread: %s\n", SDL_GetError());
+    }
+
+    cave->drawn_valid = 0; // New terrain, redraw everything
+    cave->drawn_pod_count = 0;
+    if (!frame) return;
+    CaveSnapshot snap;
+    cave_snapshot(cave, &snap);
+    draw_cave(cave, frame, &snap, cave->scroll_offset);
+}
+
+void cave_update(Cave *cave, float dt) {
+    cave->prev_scroll_offset = cave->scroll_offset;
+
+    // Hand back the chunks nothing will read again (a frame may be drawing
+    // from held_offset, the next blends from the previous tick, and a saved
+    // state may be loaded)
+    Sint64 oldest = cave->held_offset < (Sint64)cave->prev_scroll_offset ? cave->held_offset : (Sint64)cave->prev_scroll_offset;
+    oldest -= CAVE_ROLLBACK_COLUMNS;
+    int first = oldest < 0 ? 0 : (int)(oldest / CAVE_CHUNK_WIDTH);
+    if (first > cave->view_first) {
+        cave->view_first = first;
+        SDL_MemoryBarrierRelease();
+        SDL_AtomicSet(&cave->first_chunk, first);
+        if (cave->worker) SDL_SemPost(cave->wake);
+    }
+    if (cave->worker) {
+        cave->ready = SDL_AtomicGet(&cave->ready_chunks);
+        SDL_MemoryBarrierAcquire();
+    } else {
+        while (cave->gen.next_chunk < first + cave->chunks) generate_chunk(cave, &cave->gen);
+        cave->ready = cave->gen.next_chunk;
+    }
+
+    // Never scroll onto terrain that isn't there yet. This only happens if
+    // the worker is starved for seconds, and makes that run unrepeatable
+    double next = cave->scroll_offset + CAVE_SCROLL_SPEED * dt;
+    if ((Sint64)next + SCREEN_WIDTH >= (Sint64)cave->ready * CAVE_CHUNK_WIDTH) {
+        cave->stalls++;
+        return;
+    }
+    cave->scroll_offset = next;
+}
 
-    // Smooth transition for loop
-    for (int x = TERRAIN_WIDTH - 50; x < TERRAIN_WIDTH; x++) {
-        float t = (float)(x - (TERRAIN_WIDTH - 50)) / 50.0f;
-        top_terrain[x] = (int)((1.0f - t) * top_terrain[x] + t * start_top);
-        bottom_terrain[x] = (int)((1.0f - t) * bottom_terrain[x] + t * start_bottom);
+void cave_save(const Cave *cave, CaveState *state) {
+    state->prev_scroll = cave->prev_scroll_offset;
+    state->scroll = cave->scroll_offset;
+    state->first_bucket = (Sint64)cave->prev_scroll_offset / POD_BUCKET_WIDTH;
+    Sint64 last = ((Sint64)cave->scroll_offset + SCREEN_WIDTH - 1 + CAVE_ROLLBACK_COLUMNS) / POD_BUCKET_WIDTH;
+    Sint64 generated = (Sint64)cave->ready * CHUNK_BUCKETS;
+    if (last >= generated) last = generated - 1; // Not generated yet, so untouched
+    state->bucket_count = (int)(last - state->first_bucket + 1);
+    int pods = 0;
+    for (int b = 0; b < state->bucket_count; b++) {
+        const PodBucket *bucket = bucket_at(cave, state->first_bucket + b);
+        state->bucket_pods[b] = (Uint8)bucket->count;
+        for (int i = 0; i < bucket->count; i++) state->pods[pods++] = bucket->pods[i];
     }
 }
 
-void cave_init(SDL_Texture *texture) {
-    fuel_pod_count = 0; // Reset fuel pods
-    generate_terrain();
-    draw_cave(texture);
+void cave_load(Cave *cave, const CaveState *state) {
+    cave->prev_scroll_offset = state->prev_scroll;
+    cave->scroll_offset = state->scroll;
+    int pods = 0;
+    for (int b = 0; b < state->bucket_count; b++) {
+        PodBucket *bucket = bucket_at(cave, state->first_bucket + b);
+        bucket->count = state->bucket_pods[b];
+        for (int i = 0; i < bucket->count; i++) bucket->pods[i] = state->pods[pods++];
+    }
 }
 
-void cave_update_and_render(float delta_time, SDL_Texture *texture) {
-    scroll_offset += SCROLL_SPEED * delta_time;
-    if (scroll_offset >= TERRAIN_WIDTH) {
-        scroll_offset -= TERRAIN_WIDTH;
+Uint32 cave_hash(const CaveState *state, Uint32 hash) {
+    hash = hash_bytes(hash, &state->prev_scroll, sizeof(state->prev_scroll));
+    hash = hash_bytes(hash, &state->scroll, sizeof(state->scroll));
+
+    // Only the buckets on screen: how far past them a state reaches
+    // depends on how far ahead the generator happened to be
+    int buckets = (int)(((Sint64)state->scroll + SCREEN_WIDTH - 1) / POD_BUCKET_WIDTH - state->first_bucket + 1);
+    if (buckets > state->bucket_count) buckets = state->bucket_count;
+    int pods = 0;
+    for (int b = 0; b < buckets; b++) pods += state->bucket_pods[b];
+    hash = hash_bytes(hash, state->bucket_pods, buckets);
+    for (int i = 0; i < pods; i++) {
+        hash = hash_bytes(hash, &state->pods[i].x, sizeof(state->pods[i].x));
+        hash = hash_bytes(hash, &state->pods[i].y, sizeof(state->pods[i].y));
     }
-    draw_cave(texture);
+    return hash;
+}
+
+void cave_snapshot(const Cave *cave, CaveSnapshot *snap) {
+    snap->prev_scroll = cave->prev_scroll_offset;
+    snap->scroll = cave->scroll_offset;
+    snap->pod_count = 0;
+    Sint64 first = (Sint64)cave->prev_scroll_offset / POD_BUCKET_WIDTH;
+    Sint64 last = ((Sint64)cave->scroll_offset + SCREEN_WIDTH - 1) / POD_BUCKET_WIDTH;
+    for (Sint64 b = first; b <= last; b++) {
+        const PodBucket *bucket = bucket_at(cave, b);
+        for (int i = 0; i < bucket->count && snap->pod_count < CAVE_SNAPSHOT_PODS; i++) {
+            snap->pods[snap->pod_count++] = bucket->pods[i];
+        }
+    }
+}
+
+void cave_hold(Cave *cave, const CaveSnapshot *snap) {
+    Sint64 oldest = (Sint64)snap->prev_scroll;
+    cave->held_offset = cave->drawn_valid && cave->drawn_offset < oldest ? cave->drawn_offset : oldest;
+}
+
+void cave_render(Cave *cave, Frame *frame, const CaveSnapshot *snap, float alpha) {
+    draw_cave(cave, frame, snap, snap->prev_scroll + (snap->scroll - snap->prev_scroll) * alpha);
 }
 
-float cave_get_scroll_offset(void) {
-    return scroll_offset;
+void cave_restore(const Cave *cave, Frame *frame, int x, int y, int w, int h) {
+    draw_terrain(cave, frame, x, y, w, h);
 }
 
-int cave_get_fuel_pod_count(void) {
-    return fuel_pod_count;
+Uint32 cave_color(const Cave *cave, int x, int y) {
+    Sint64 world_x = cave->drawn_offset + x;
+    return y < cave_top(cave, world_x) || y >= cave_bottom(cave, world_x) ? 0x808080FF : 0x000000FF;
 }
 
-FuelPod* cave_get_fuel_pods(void) {
-    return fuel_pods;
+Sint64 cave_get_scroll_offset(const Cave *cave) {
+    return (Sint64)cave->scroll_offset;
 }
 
-void cave_consume_fuel_pod(int index) {
-    if (index >= 0 && index < fuel_pod_count && fuel_pods[index].active) {
-        fuel_pods[index].active = 0;
+// Pods are 4 wide, so one starting up to 3 columns left of a rectangle can overlap it
+static int pod_overlaps(const FuelPod *pod, Sint64 world_x, int y, int w, int h) {
+    return world_x + w > pod->x && world_x < pod->x + 4 && y + h > pod->y && y < pod->y + 4;
+}
+
+int cave_take_fuel_pods(Cave *cave, Sint64 world_x, int y, int w, int h) {
+    int taken = 0;
+    Sint64 b = (world_x - 3) / POD_BUCKET_WIDTH;
+    Sint64 kept = (Sint64)cave->view_first * CHUNK_BUCKETS;
+    if (b < kept) b = kept; // Handed back to the generator
+    for (; b <= (world_x + w - 1) / POD_BUCKET_WIDTH; b++) {
+        PodBucket *bucket = bucket_at(cave, b);
+        for (int i = 0; i < bucket->count;) {
+            if (pod_overlaps(&bucket->pods[i], world_x, y, w, h)) {
+                bucket->pods[i] = bucket->pods[--bucket->count];
+                taken++;
+            } else {
+                i++;
+            }
+        }
+    }
+    return taken;
+}
+
+int cave_find_fuel_pods(const Cave *cave, Sint64 world_x, int y, int w, int h, int *ids, int max) {
+    int found = 0;
+    Sint64 b = (world_x - 3) / POD_BUCKET_WIDTH;
+    if (b < 0) b = 0;
+    for (; b <= (world_x + w - 1) / POD_BUCKET_WIDTH; b++) {
+        const PodBucket *bucket = bucket_at(cave, b);
+        int slot = (int)(b % ((Sint64)cave->chunks * CHUNK_BUCKETS)) * POD_BUCKET_PODS;
+        for (int i = 0; i < bucket->count && found < max; i++) {
+            if (pod_overlaps(&bucket->pods[i], world_x, y, w, h)) ids[found++] = slot + i;
+        }
     }
+    return found;
+}
+
+int cave_pod_ids(const Cave *cave) {
+    return cave->chunks * CHUNK_BUCKETS * POD_BUCKET_PODS;
 }
\ No newline at end of file
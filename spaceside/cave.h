@@ -2,29 +2,113 @@
 #define CAVE_H
 
 #include <SDL2/SDL.h>
+#include "frame.h"
 
-// Screen dimensions and terrain width
+// Screen dimensions
 #define SCREEN_WIDTH 800
 #define SCREEN_HEIGHT 600
-#define TERRAIN_WIDTH (SCREEN_WIDTH * 10)
-#define MAX_FUEL_PODS 20
 
-void cave_init(SDL_Texture *texture);
-void cave_update_and_render(float delta_time, SDL_Texture *texture);
+// Scroll speed, px/s
+#define CAVE_SCROLL_SPEED 25.0f
 
-// Accessors for terrain and offset
-extern int top_terrain[TERRAIN_WIDTH];
-extern int bottom_terrain[TERRAIN_WIDTH];
-float cave_get_scroll_offset(void);
+// Columns behind the view kept for loading a saved state (netplay rolls
+// back at most a few pixels of scrolling)
+#define CAVE_ROLLBACK_COLUMNS 32
 
-// Fuel pod structure and accessors
+// The cave is endless: it's generated in chunks ahead of the view into a
+// fixed ring (by a worker thread, for the game), so memory stays the same
+// however far it scrolls
+#define CAVE_CHUNK_WIDTH 256
+#define CAVE_CHUNKS 16 // Ring the game scrolls through
+
+// Fewest chunks a ring can have: the view, the rollback columns behind it
+// and a chunk of slack either side
+#define CAVE_MIN_CHUNKS ((SCREEN_WIDTH + CAVE_ROLLBACK_COLUMNS) / CAVE_CHUNK_WIDTH + 3)
+
+// One cave; any number can run side by side
+typedef struct Cave Cave;
+
+// Fuel pod, in world coordinates
 typedef struct {
-    float x, y;     // Position
-    int active;     // 1 if active, 0 if consumed
+    Sint64 x;
+    int y;
 } FuelPod;
 
-int cave_get_fuel_pod_count(void);
-FuelPod* cave_get_fuel_pods(void);
-void cave_consume_fuel_pod(int index);
+// Most pods a frame can show
+#define CAVE_SNAPSHOT_PODS 128
+
+// What drawing a frame needs from the simulation, copied out after its
+// ticks so the next frame can be simulated while this one is drawn. The
+// terrain stays in the ring, which keeps it as long as cave_hold says
+typedef struct {
+    double prev_scroll, scroll; // Previous and current tick
+    FuelPod pods[CAVE_SNAPSHOT_PODS];
+    int pod_count;
+} CaveSnapshot;
+
+#define CAVE_STATE_BUCKETS 32
+#define CAVE_STATE_PODS 128
+
+// Everything a tick changes in the cave: the scroll, and the pods in every
+// bucket ships could reach before the scroll moves CAVE_ROLLBACK_COLUMNS on
+typedef struct {
+    double prev_scroll, scroll;
+    Sint64 first_bucket;
+    int bucket_count;
+    Uint8 bucket_pods[CAVE_STATE_BUCKETS]; // Pods in each bucket, stored one bucket after another
+    FuelPod pods[CAVE_STATE_PODS];
+} CaveState;
+
+// Make a cave whose rounds are seeded by `seed`, with a ring of `chunks`
+// (at least CAVE_MIN_CHUNKS) filled by a worker thread if `background`, or
+// on the ticking thread otherwise. Returns NULL on failure
+Cave *cave_create(unsigned int seed, int chunks, int background);
+// Stop the generator thread and free the cave
+void cave_destroy(Cave *cave);
+// Start a new cave at world x 0 and draw it (without a frame, the cave is
+// never drawn)
+void cave_init(Cave *cave, Frame *frame);
+// Scroll one tick of `dt` seconds
+void cave_update(Cave *cave, float dt);
+// Save and load the state of the last tick, for rolling back (a loaded
+// state must be at most CAVE_ROLLBACK_COLUMNS behind the scroll)
+void cave_save(const Cave *cave, CaveState *state);
+void cave_load(Cave *cave, const CaveState *state);
+// Fold a saved state into `hash` (hash.h)
+Uint32 cave_hash(const CaveState *state, Uint32 hash);
+// Copy out the scroll and the pods a frame drawn now could show
+void cave_snapshot(const Cave *cave, CaveSnapshot *snap);
+// Keep the terrain the frame holds and the terrain `snap` shows from being
+// handed back to the generator (call before ticking, with the snapshot
+// that will be drawn meanwhile)
+void cave_hold(Cave *cave, const CaveSnapshot *snap);
+// Draw a snapshot blended `alpha` of the way from its previous tick to its
+// current one. The frame keeps the cave between calls and only newly
+// exposed columns are rasterized, so anything drawn over it must be erased
+// (cave_restore) first
+void cave_render(Cave *cave, Frame *frame, const CaveSnapshot *snap, float alpha);
+// Put the cave back under a screen rectangle, as of the last cave_render
+void cave_restore(const Cave *cave, Frame *frame, int x, int y, int w, int h);
+// The cave's color at a screen pixel, as of the last cave_render (pods aside)
+Uint32 cave_color(const Cave *cave, int x, int y);
+
+// Whole pixels scrolled this tick; screen x + this is the world x
+Sint64 cave_get_scroll_offset(const Cave *cave);
+// Cave ceiling and floor at a world column on screen this tick
+int cave_top(const Cave *cave, Sint64 world_x);
+int cave_bottom(const Cave *cave, Sint64 world_x);
+// Lowest ceiling and highest floor over world columns [first, last], in
+// constant time per chunk the range touches
+void cave_range(const Cave *cave, Sint64 first, Sint64 last, int *max_top, int *min_bottom);
+// 1 if a w x h box moving straight from (x0, y0) to (x1, y1) (world x,
+// screen y) touches the ceiling or floor anywhere along the way
+int cave_sweep_hits(const Cave *cave, Sint64 x0, int y0, Sint64 x1, int y1, int w, int h);
+// Consume the pods overlapping a world rectangle; returns how many
+int cave_take_fuel_pods(Cave *cave, Sint64 world_x, int y, int w, int h);
+// Find them instead, for caves many rounds share and only read: writes the
+// ids (below cave_pod_ids) of at most `max` pods overlapping the rectangle
+// and returns how many. Ids hold while nothing takes pods from the cave
+int cave_find_fuel_pods(const Cave *cave, Sint64 world_x, int y, int w, int h, int *ids, int max);
+int cave_pod_ids(const Cave *cave);
 
 #endif // CAVE_H
\ No newline at end of file
@@ -0,0 +1,176 @@
+#include <SDL2/SDL.h>
+#include "env.h"
+#include "timestep.h"
+#include "cave.h"
+#include "ship.h"
+#include "rng.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+// Cave Scroller as an environment: one ship per instance, flown by the
+// action. The reward is 1 for every tick it survives, and the round ends
+// when it crashes (or, surviving, when it reaches the end of the cave).
+//
+// Instances share one cave, generated up front and then only read, and
+// each round starts at a random chunk in its first half. Each instance
+// keeps its scroll, its ship and the pods it has taken, one array per
+// field indexed by instance, so a batch streams through only those and
+// the terrain stays in cache however many instances run
+#define ENV_CAVE_CHUNKS 128
+#define ROUND_END ((Sint64)ENV_CAVE_CHUNKS * CAVE_CHUNK_WIDTH - 2 * SCREEN_WIDTH) // Scroll that ends a round
+
+// Samples of the cave ahead of the ship in an observation, each the
+// narrowest gap over SAMPLE_WIDTH columns
+#define CAVE_SAMPLES 16
+#define SAMPLE_WIDTH 32
+#define OBSERVATION_SIZE (5 + 2 * CAVE_SAMPLES)
+
+// Most pods an 8x8 ship can touch at once (two buckets' worth)
+#define MAX_TOUCHED_PODS 8
+
+typedef struct {
+    int count;
+    Cave *cave;
+    int pod_words; // Words of taken-pod bits per instance
+    float *x, *y, *vel_x, *vel_y;
+    float *fuel;
+    Sint64 *world_x; // Ship's left edge in the cave, as of the last tick
+    double *scroll;
+    Rng *rng;        // Picks where each round starts
+    Uint32 *taken;   // Bit per pod id of the cave, pod_words per instance
+} Instances;
+
+// Point the arrays into the block after the struct, each starting a cache
+// line (so batches of 16 instances never share one); with `instances`
+// NULL, only measure the block
+static size_t lay_out(Instances *instances, int n, int pod_words) {
+    Uint8 *base = instances ? (Uint8 *)(((uintptr_t)(instances + 1) + 63) & ~(uintptr_t)63) : NULL;
+    size_t size = 0;
+#define INSTANCE_ARRAY(field, type, per) \
+    size = (size + 63) & ~(size_t)63; \
+    if (instances) instances->field = (type *)(base + size); \
+    size += (size_t)n * (per) * sizeof(type);
+    INSTANCE_ARRAY(x, float, 1)
+    INSTANCE_ARRAY(y, float, 1)
+    INSTANCE_ARRAY(vel_x, float, 1)
+    INSTANCE_ARRAY(vel_y, float, 1)
+    INSTANCE_ARRAY(fuel, float, 1)
+    INSTANCE_ARRAY(world_x, Sint64, 1)
+    INSTANCE_ARRAY(scroll, double, 1)
+    INSTANCE_ARRAY(rng, Rng, 1)
+    INSTANCE_ARRAY(taken, Uint32, pod_words)
+#undef INSTANCE_ARRAY
+    return size + 63; // And room to align the first
+}
+
+// New round: a random stretch of the cave, the ship a quarter of the way
+// across the screen in the middle of the gap, with a full tank
+static void reset(Instances *in, int i) {
+    in->scroll[i] = (double)rng_range(&in->rng[i], ENV_CAVE_CHUNKS / 2) * CAVE_CHUNK_WIDTH;
+    in->x[i] = SCREEN_WIDTH / 4.0f;
+    in->world_x[i] = (Sint64)in->x[i] + (Sint64)in->scroll[i];
+    int top, bottom;
+    cave_range(in->cave, in->world_x[i], in->world_x[i] + 7, &top, &bottom);
+    in->y[i] = (top + bottom) / 2 - 4.0f;
+    in->vel_x[i] = 0.0f;
+    in->vel_y[i] = 0.0f;
+    in->fuel[i] = 100.0f;
+    SDL_memset(in->taken + (size_t)i * in->pod_words, 0, in->pod_words * sizeof(Uint32));
+}
+
+static void *create(int n, unsigned int seed, const Uint32 *seeds) {
+    Cave *cave = cave_create(seed, ENV_CAVE_CHUNKS, 0);
+    if (!cave) return NULL;
+    cave_init(cave, NULL); // Fills every chunk
+    int pod_words = (cave_pod_ids(cave) + 31) / 32;
+    Instances *in = calloc(1, sizeof(Instances) + lay_out(NULL, n, pod_words));
+    if (!in) {
+        printf("Out of memory for %d CaveScroller instances\n", n);
+        cave_destroy(cave);
+        return NULL;
+    }
+    lay_out(in, n, pod_words);
+    in->count = n;
+    in->cave = cave;
+    in->pod_words = pod_words;
+    for (int i = 0; i < n; i++) {
+        rng_seed(&in->rng[i], seeds[i]);
+        reset(in, i);
+    }
+    return in;
+}
+
+static void destroy(void *data) {
+    Instances *in = data;
+    cave_destroy(in->cave);
+    free(in);
+}
+
+// The ship's tick as ships_update runs it for a player, against the shared
+// cave, taking each pod once per round
+static void step(void *data, int first, int last, const Uint8 *actions, float *rewards, Uint8 *dones) {
+    Instances *in = data;
+    for (int i = first; i < last; i++) {
+        in->scroll[i] += CAVE_SCROLL_SPEED * SIM_DT;
+        Sint64 scroll_offset = (Sint64)in->scroll[i];
+        ship_steer(&in->vel_x[i], &in->vel_y[i], &in->fuel[i],
+                   (actions[i] & ENV_LEFT) != 0, (actions[i] & ENV_RIGHT) != 0, (actions[i] & ENV_THRUST) != 0, SIM_DT);
+        float prev_y = in->y[i];
+        ship_move(&in->x[i], &in->y[i], in->vel_x[i], &in->vel_y[i], SIM_DT);
+
+        // Collision along the whole path since the last tick
+        Sint64 prev_world_x = in->world_x[i];
+        in->world_x[i] = (Sint64)in->x[i] + scroll_offset;
+        int crashed = cave_sweep_hits(in->cave, prev_world_x, (int)prev_y, in->world_x[i], (int)in->y[i], 8, 8);
+        if (!crashed) {
+            int ids[MAX_TOUCHED_PODS];
+            int found = cave_find_fuel_pods(in->cave, in->world_x[i], (int)in->y[i], 8, 8, ids, MAX_TOUCHED_PODS);
+            Uint32 *taken = in->taken + (size_t)i * in->pod_words;
+            int pods = 0;
+            for (int p = 0; p < found; p++) {
+                Uint32 bit = 1u << (ids[p] & 31);
+                if (taken[ids[p] >> 5] & bit) continue;
+                taken[ids[p] >> 5] |= bit;
+                pods++;
+            }
+            if (pods > 0) {
+                in->fuel[i] += SHIP_FUEL_PER_POD * pods;
+                if (in->fuel[i] > 100.0f) in->fuel[i] = 100.0f;
+            }
+        }
+
+        rewards[i] = crashed ? 0.0f : 1.0f;
+        dones[i] = (Uint8)(crashed || scroll_offset >= ROUND_END);
+        if (dones[i]) reset(in, i);
+    }
+}
+
+// Ship position, velocity (hundreds of px/s) and fuel, then the ceiling
+// and floor over the columns ahead of it, as far as the screen's edge.
+// Positions are fractions of the screen
+static void observe(const void *data, int first, int last, float *out) {
+    const Instances *in = data;
+    for (int i = first; i < last; i++) {
+        *out++ = in->x[i] / SCREEN_WIDTH;
+        *out++ = in->y[i] / SCREEN_HEIGHT;
+        *out++ = in->vel_x[i] / 100.0f;
+        *out++ = in->vel_y[i] / 100.0f;
+        *out++ = in->fuel[i] / 100.0f;
+
+        Sint64 view_end = (Sint64)in->scroll[i] + SCREEN_WIDTH - 1;
+        Sint64 column = (Sint64)in->scroll[i] + (Sint64)in->x[i];
+        for (int s = 0; s < CAVE_SAMPLES; s++) {
+            Sint64 first_column = column + s * SAMPLE_WIDTH;
+            Sint64 last_column = first_column + SAMPLE_WIDTH - 1;
+            if (first_column > view_end) first_column = view_end;
+            if (last_column > view_end) last_column = view_end;
+            int top, bottom;
+            cave_range(in->cave, first_column, last_column, &top, &bottom);
+            *out++ = (float)top / SCREEN_HEIGHT;
+            *out++ = (float)bottom / SCREEN_HEIGHT;
+        }
+    }
+}
+
+const EnvGame env_game = {"CaveScroller", OBSERVATION_SIZE, create, destroy, step, observe};
\ No newline at end of file
@@ -1,22 +1,305 @@
 #include <SDL2/SDL.h>
-#include <SDL2/SDL_mixer.h>
+#include "frame.h"
+#include "audio.h"
+#include "assets.h"
+#include "bench.h"
+#include "trace.h"
+#include "timestep.h"
+#include "input.h"
+#include "pipeline.h"
+#include "netplay.h"
+#include "hash.h"
 #include "cave.h"
-#include "player1.h"
-#include "player2.h"
+#include "ship.h"
+#include "particles.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
-// Global pixel buffer and pitch
-Uint32 *pixels;
-int pitch;
+// Headless input: both ships feather their main engines and weave sideways
+static const ScriptedKey input_script[] = {
+    {SDL_SCANCODE_W, 10, 5, 0},
+    {SDL_SCANCODE_A, 120, 15, 0},
+    {SDL_SCANCODE_D, 120, 15, 60},
+    {SDL_SCANCODE_UP, 10, 5, 3},
+    {SDL_SCANCODE_LEFT, 100, 12, 50},
+    {SDL_SCANCODE_RIGHT, 100, 12, 0},
+};
+
+// Player 1 on WASD with its gauge on the left, player 2 on the arrows on the right
+static const ShipControls player_controls[2] = {
+    {SDL_SCANCODE_A, SDL_SCANCODE_D, SDL_SCANCODE_W, 10, 0x00FF00FF},                // Green
+    {SDL_SCANCODE_LEFT, SDL_SCANCODE_RIGHT, SDL_SCANCODE_UP, SCREEN_WIDTH - 30, 0x0000FFFF}, // Blue
+};
+
+static const Uint32 bot_colors[] = {0xFF60FFFF, 0xFF6060FF, 0x60FF60FF, 0xA0A0FFFF};
+
+// Computer-flown ships added to every round (--bots N)
+static int bot_count = 0;
+
+// The cave this game flies through, and its ships
+static Cave *cave;
+static Ships *ships;
+
+// Netplay (--netplay PLAYER PORT HOST:PORT [--net-lag MS]): this process
+// flies one player's ship and the peer at HOST:PORT flies the other
+static int net_player = -1;
+static int net_port;
+static const char *net_peer;
+static int net_lag;
+
+// Take the game's own flags out of the arguments, leaving the rest for the bench
+static int parse_game_args(int *argc, char *argv[]) {
+    int kept = 1;
+    for (int i = 1; i < *argc; i++) {
+        if (strcmp(argv[i], "--bots") == 0 && i + 1 < *argc) {
+            bot_count = atoi(argv[++i]);
+            if (bot_count < 0 || bot_count > MAX_SHIPS - 2) {
+                printf("--bots takes 0 to %d\n", MAX_SHIPS - 2);
+                return 0;
+            }
+        } else if (strcmp(argv[i], "--netplay") == 0 && i + 3 < *argc) {
+            net_player = atoi(argv[++i]) - 1;
+            net_port = atoi(argv[++i]);
+            net_peer = argv[++i];
+            if (net_player < 0 || net_player > 1) {
+                printf("--netplay takes player 1 or 2\n");
+                return 0;
+            }
+        } else if (strcmp(argv[i], "--net-lag") == 0 && i + 1 < *argc) {
+            net_lag = atoi(argv[++i]);
+        } else {
+            argv[kept++] = argv[i];
+        }
+    }
+    *argc = kept;
+    return 1;
+}
+
+// Saved states for rolling back, one per NetGame slot
+typedef struct {
+    CaveState cave;
+    ShipState ships;
+} NetState;
+
+static NetState net_states[NET_STATE_SLOTS];
+
+static void net_save(int slot) {
+    cave_save(cave, &net_states[slot].cave);
+    ships_save(ships, &net_states[slot].ships);
+}
+
+static void net_load(int slot) {
+    cave_load(cave, &net_states[slot].cave);
+    ships_load(ships, &net_states[slot].ships);
+}
+
+static Uint32 net_hash(int slot) {
+    return ships_hash(&net_states[slot].ships, cave_hash(&net_states[slot].cave, HASH_INIT));
+}
+
+// A player's input is three bits: left, right, thrust
+static Uint8 player_input(const Uint8 *keys, const ShipControls *c) {
+    return (Uint8)(keys[c->left] | keys[c->right] << 1 | keys[c->thrust] << 2);
+}
+
+static void net_tick(const Uint8 inputs[2], int replaying) {
+    Uint8 keys[SDL_NUM_SCANCODES] = {0};
+    for (int p = 0; p < 2; p++) {
+        keys[player_controls[p].left] = inputs[p] & 1;
+        keys[player_controls[p].right] = (inputs[p] >> 1) & 1;
+        keys[player_controls[p].thrust] = (inputs[p] >> 2) & 1;
+    }
+    cave_update(cave, SIM_DT);
+    ships_update(ships, SIM_DT, keys, !replaying);
+}
+
+static const NetGame net_game = {net_save, net_load, net_hash, net_tick};
+
+// One frame of simulation, drawn while the next one is simulated (--pipeline)
+typedef struct {
+    CaveSnapshot cave;
+    ShipSnapshot ships;
+    float alpha;
+    int over; // Every ship crashed (netplay: for certain), or the session failed
+} Snapshot;
+
+static Snapshot snapshots[2];
+static int front = 0;     // Snapshot being drawn; the simulation writes the other
+static int steps_to_run;  // Ticks in the frame being simulated
+static float step_alpha;  // Where that frame is drawn between its last two ticks
+static int round_over;    // Set by the simulation
+
+static void take_snapshot(Snapshot *snap, float alpha) {
+    cave_snapshot(cave, &snap->cave);
+    ships_snapshot(ships, &snap->ships);
+    snap->alpha = alpha;
+    snap->over = round_over;
+}
+
+// Netplay frame: this player's ticks run as soon as the peer's input can
+// be guessed, and the round ends only once every crash is confirmed
+static int simulate_netplay(void) {
+    if (!net_poll()) return 0;
+    for (int i = 0; i < steps_to_run && net_ready(); i++) {
+        input_tick();
+        net_advance(player_input(input_keys(), &player_controls[net_player]));
+    }
+    net_send();
+    int slot = net_confirmed_slot();
+    return slot < 0 || net_states[slot].ships.alive > 0;
+}
+
+// Run a frame's fixed ticks into the back snapshot; ships collide against
+// the cave as of the same tick. Ticks stop at game over so the next round
+// starts the same way every time
+static void simulate(void *data) {
+    (void)data;
+    Uint64 phase = trace_begin();
+    if (net_peer) {
+        round_over = !simulate_netplay();
+    } else {
+        for (int i = 0; i < steps_to_run && ships_alive(ships) > 0; i++) {
+            if (!input_tick()) break;
+            cave_update(cave, SIM_DT);
+            ships_update(ships, SIM_DT, input_keys(), 1);
+        }
+        round_over = ships_alive(ships) == 0;
+    }
+    take_snapshot(&snapshots[!front], step_alpha);
+    trace_end("update", phase);
+}
+
+// Effects, read off the snapshots as they're drawn: exhaust under
+// thrusting ships, debris where one crashed and sparks where one took fuel.
+// Particles are in world coordinates (screen x plus the scroll) and belong
+// to the drawing thread alone, so neither the pipeline nor netplay's
+// rollbacks see them (a crash rolled back still leaves its debris)
+#define EFFECT_PARTICLES 32768
+#define EFFECT_GRAVITY 30.0f // px/s^2
+#define EXHAUST_PER_TICK 2
+#define DEBRIS_PARTICLES 300
+#define SPARK_PARTICLES 60
+static Particles *particles;
+static Rng effects_rng;
+static Uint8 effects_dead[MAX_SHIPS]; // Ships as of the last snapshot drawn
+static float effects_fuel[MAX_SHIPS];
+static Uint64 effects_ticks;
+
+static const Uint32 exhaust_colors[] = {0xFFFFA0FF, 0xFFC000FF, 0xFF8000FF};
+static const Uint32 debris_colors[] = {0xFFFF00FF, 0xFF8000FF, 0xFF0000FF, 0xA0A0A0FF};
+static const Uint32 spark_colors[] = {0x00FF00FF, 0xA0FFA0FF, 0xFFFFFFFF};
+static const ParticleEmitter exhaust = {3.14159265f, 0.3f, 60.0f, 140.0f, 0.15f, 0.35f, exhaust_colors, SDL_arraysize(exhaust_colors)};
+static const ParticleEmitter debris = {0.0f, 3.14159265f, 30.0f, 200.0f, 0.5f, 1.5f, debris_colors, SDL_arraysize(debris_colors)};
+static const ParticleEmitter sparks = {0.0f, 3.14159265f, 40.0f, 120.0f, 0.2f, 0.5f, spark_colors, SDL_arraysize(spark_colors)};
+
+// Forget the last round's effects (its frame was cleared)
+static void effects_reset(const ShipSnapshot *snap) {
+    particles_clear(particles);
+    memcpy(effects_dead, snap->dead, sizeof(effects_dead));
+    memcpy(effects_fuel, snap->fuel, sizeof(effects_fuel));
+    effects_ticks = snap->ticks;
+}
+
+// Spawn what happened since the last snapshot drawn, then move every
+// particle on by the ticks it took
+static void effects_update(const Snapshot *shown) {
+    const ShipSnapshot *snap = &shown->ships;
+    int ticks = snap->ticks > effects_ticks ? (int)(snap->ticks - effects_ticks) : 0;
+    float scroll = (float)shown->cave.scroll;
+    for (int i = 0; i < snap->count; i++) {
+        float x = snap->x[i] + 4.0f + scroll, y = snap->y[i] + 4.0f;
+        if (snap->dead[i] && !effects_dead[i]) {
+            particles_emit(particles, &debris, &effects_rng, DEBRIS_PARTICLES, x, y, 0.0f, 0.0f);
+        } else if (snap->fuel[i] > effects_fuel[i] + 1.0f) {
+            particles_emit(particles, &sparks, &effects_rng, SPARK_PARTICLES, x, y, 0.0f, 0.0f);
+        }
+        if (snap->main_engine[i] && !snap->dead[i]) {
+            particles_emit(particles, &exhaust, &effects_rng, EXHAUST_PER_TICK * ticks, x, y + 6.0f, 0.0f, 0.0f);
+        }
+        effects_dead[i] = snap->dead[i];
+        effects_fuel[i] = snap->fuel[i];
+    }
+    effects_ticks = snap->ticks;
+    particles_update(particles, ticks * SIM_DT);
+}
+
+// Draw the particles blended like the cave, a tick behind the simulation
+static void effects_render(Frame *frame, const Snapshot *shown) {
+    double scroll = shown->cave.prev_scroll + (shown->cave.scroll - shown->cave.prev_scroll) * shown->alpha;
+    ParticleView view = {(float)scroll, 0.0f, 1.0f, (shown->alpha - 1.0f) * SIM_DT, 1};
+    particles_render(particles, frame, &view);
+}
+
+// Particles come off a pixel at a time: restoring the rectangle around
+// them would rasterize most of the cave again whenever ships are spread out
+static Uint32 effects_under(const void *data, int x, int y) {
+    return cave_color(data, x, y);
+}
+
+// Clear the screen and reset the cave, both players and the bots
+static int start_round(SDL_Texture *texture) {
+    Frame *frame = begin_frame(texture);
+    if (!frame) return 0;
+    clear_frame(frame, 0x000000FF); // Black space
+
+    // Initialize modules
+    cave_init(cave, frame);
+    ships_init(ships);
+    ships_add_player(ships, SCREEN_WIDTH / 4.0f, SCREEN_HEIGHT / 2.0f, 0xFFFF00FF, &player_controls[0]);     // Yellow
+    ships_add_player(ships, SCREEN_WIDTH * 3 / 4.0f, SCREEN_HEIGHT / 2.0f, 0x00FFFFFF, &player_controls[1]); // Cyan
+    for (int i = 0; i < bot_count; i++) {
+        // Spread across the screen, clear of the gauges
+        float bot_x = 40.0f + (SCREEN_WIDTH - 88.0f) * (i + 0.5f) / bot_count;
+        ships_add_bot(ships, bot_x, bot_colors[i % SDL_arraysize(bot_colors)]);
+    }
+    round_over = 0;
+    take_snapshot(&snapshots[front], 0.0f);
+    effects_reset(&snapshots[front].ships);
+    end_frame(frame);
+    return 1;
+}
 
 int main(int argc, char *argv[]) {
+    BenchOptions options = {.seed = 1};
+    if (!parse_game_args(&argc, argv) || !bench_parse_args(argc, argv, &options)) return 1;
+    if (net_peer && (options.record_path || options.replay_path)) {
+        printf("--netplay can't record or replay\n");
+        return 1;
+    }
+    if (!bench_init(&options, input_script, SDL_arraysize(input_script))) return 1;
+    cave = cave_create(bench_seed(), CAVE_CHUNKS, 1);
+    ships = cave ? ships_create(cave, bot_count + 2) : NULL;
+    particles = particles_create(EFFECT_PARTICLES, EFFECT_GRAVITY);
+    if (!ships || !particles) {
+        ships_destroy(ships);
+        cave_destroy(cave);
+        particles_destroy(particles);
+        bench_shutdown();
+        return 1;
+    }
+    rng_seed(&effects_rng, bench_seed());
+
+    // Both sides must build the same rounds
+    if (net_peer) {
+        unsigned int seed = bench_seed();
+        Uint32 session = hash_bytes(hash_bytes(HASH_INIT, &seed, sizeof(seed)), &bot_count, sizeof(bot_count));
+        if (!net_init(net_player, net_port, net_peer, session, net_lag, &net_game)) {
+            ships_destroy(ships);
+            cave_destroy(cave);
+            particles_destroy(particles);
+            bench_shutdown();
+            return 1;
+        }
+    }
+
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0) {
         printf("SDL Init failed: %s\n", SDL_GetError());
         return 1;
     }
 
-    if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
-        printf("SDL_mixer Init failed: %s\n", Mix_GetError());
+    if (!audio_init()) {
+        printf("Audio Init failed: %s\n", SDL_GetError());
         SDL_Quit();
         return 1;
     }
@@ -26,16 +309,16 @@ int main(int argc, char *argv[]) {
                                           SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
     if (!window) {
         printf("Window creation failed: %s\n", SDL_GetError());
-        Mix_CloseAudio();
+        audio_shutdown();
         SDL_Quit();
         return 1;
     }
 
-    SDL_Renderer *renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    SDL_Renderer *renderer = SDL_CreateRenderer(window, -1, bench_renderer_flags());
     if (!renderer) {
         printf("Renderer creation failed: %s\n", SDL_GetError());
         SDL_DestroyWindow(window);
-        Mix_CloseAudio();
+        audio_shutdown();
         SDL_Quit();
         return 1;
     }
@@ -47,66 +330,124 @@ int main(int argc, char *argv[]) {
         printf("Texture creation failed: %s\n", SDL_GetError());
         SDL_DestroyRenderer(renderer);
         SDL_DestroyWindow(window);
-        Mix_CloseAudio();
+        audio_shutdown();
         SDL_Quit();
         return 1;
     }
 
-    // Clear screen
-    SDL_LockTexture(texture, NULL, (void **)&pixels, &pitch);
-    for (int i = 0; i < SCREEN_WIDTH * SCREEN_HEIGHT; i++) {
-        pixels[i] = 0x000000FF; // Black space
+    // Every ship plays its sounds from the same mapped archive
+    int assets_ok = assets_open("cavescroller.pak");
+    if (assets_ok) ships_acquire_sounds();
+    if (!assets_ok || !start_round(texture)) {
+        SDL_DestroyTexture(texture);
+        SDL_DestroyRenderer(renderer);
+        SDL_DestroyWindow(window);
+        audio_shutdown();
+        assets_close();
+        SDL_Quit();
+        return 1;
     }
-    SDL_UnlockTexture(texture);
 
-    // Initialize modules
-    cave_init(texture);
-    player1_init(texture);
-    player2_init(texture);
+    // Phase timings; F12 or exit writes them out (tracing is skipped if allocation fails)
+    trace_init("cavescroller_trace.json");
 
-    // Game loop (60 Hz)
+    // Game loop (simulation at SIM_HZ, rendering as fast as the display allows).
+    // Pipelined, frame N is drawn and presented while N + 1 is simulated
+    int pipelined = bench_is_pipelined() && pipeline_init(simulate, NULL);
     int running = 1;
     SDL_Event event;
-    Uint32 last_time = SDL_GetTicks();
-    const float TARGET_FRAME_TIME = 1000.0f / 60.0f;
+    TimeStep step;
+    timestep_init(&step);
 
     while (running) {
+        bench_frame_begin();
+        Uint64 frame_trace = trace_begin();
+        Uint64 phase = trace_begin();
         while (SDL_PollEvent(&event)) {
             if (event.type == SDL_QUIT) {
                 running = 0;
             }
+            input_handle_event(&event);
+            trace_handle_event(&event);
         }
+        trace_end("input", phase);
 
-        Uint32 current_time = SDL_GetTicks();
-        float delta_time = (current_time - last_time) / 1000.0f;
-        last_time = current_time;
+        Frame *frame = begin_frame(texture);
+        if (!frame) break;
+
+        // Simulate the next frame, in the background when pipelined
+        steps_to_run = timestep_advance(&step);
+        step_alpha = step.alpha;
+        cave_hold(cave, &snapshots[front].cave);
+        if (pipelined) {
+            pipeline_start();
+        } else {
+            simulate(NULL);
+            front = !front;
+        }
+        const Snapshot *shown = &snapshots[front];
 
-        // Update and render modules
-        cave_update_and_render(delta_time, texture);
-        player1_update_and_render(delta_time, texture, top_terrain, bottom_terrain, (int)cave_get_scroll_offset());
-        player2_update_and_render(delta_time, texture, top_terrain, bottom_terrain, (int)cave_get_scroll_offset());
+        // Render modules into one frame
+        phase = trace_begin();
+        ships_erase(ships, frame); // Ships and effects come off before the cave scrolls under them
+        particles_erase(particles, frame, effects_under, cave);
+        cave_render(cave, frame, &shown->cave, shown->alpha);
+        trace_end("cave", phase);
+        phase = trace_begin();
+        effects_update(shown);
+        effects_render(frame, shown);
+        trace_end("effects", phase);
+        phase = trace_begin();
+        ships_render(ships, frame, &shown->ships, shown->alpha);
+        trace_end("ships", phase);
+        end_frame(frame);
 
-        // Check for game over
-        if (player1_is_dead() && player2_is_dead()) {
-            printf("Both players crashed!\n");
-            SDL_Delay(1000); // Pause to hear crash sounds
-            running = 0;
+        // Check for game over (a netplay session is a single round)
+        int over = shown->over;
+        if (over) {
+            if (pipelined) pipeline_wait(); // Nothing left to simulate, but the round belongs to the simulation
+            if (bench_is_headless() && !net_peer) {
+                if (!start_round(texture)) running = 0; // Keep going until the frame budget is spent
+            } else {
+                if (shown->ships.alive == 0) printf("Every ship crashed!\n");
+                bench_delay(1000); // Pause to hear crash sounds
+                running = 0;
+            }
         }
 
+        phase = trace_begin();
         SDL_RenderClear(renderer);
         SDL_RenderCopy(renderer, texture, NULL, NULL);
         SDL_RenderPresent(renderer);
+        trace_end("present", phase);
 
-        Uint32 frame_time = SDL_GetTicks() - current_time;
-        if (frame_time < TARGET_FRAME_TIME) {
-            SDL_Delay((Uint32)(TARGET_FRAME_TIME - frame_time));
+        // The simulated frame is the next one drawn
+        if (pipelined && !over) {
+            pipeline_wait();
+            front = !front;
         }
+
+        trace_end("frame", frame_trace);
+        if (!bench_frame_end()) running = 0; // Headless frame budget spent
+        timestep_throttle(&step);
     }
 
+    bench_report("CaveScroller");
+    bench_shutdown();
+    pipeline_shutdown();
+    if (net_peer) net_report();
+    net_shutdown();
+    ships_destroy(ships);
+    cave_destroy(cave);
+    particles_destroy(particles);
+    trace_shutdown();
+    destroy_frame();
     SDL_DestroyTexture(texture);
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
-    Mix_CloseAudio();
+    audio_shutdown(); // Stop mixing before the sounds go away
+    ships_release_sounds();
+    assets_close();
     SDL_Quit();
     return 0;
 }
\ No newline at end of file
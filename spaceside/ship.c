@@ -0,0 +1,391 @@
+#include <SDL2/SDL.h>
+#include "ship.h"
+#include "cave.h"
+#include "frame.h"
+#include "audio.h"
+#include "assets.h"
+#include "blit.h"
+#include "timestep.h"
+#include "hash.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Ship sprite (8x8)
+static const Uint8 ship_sprite[8] = {
+    0b00011000, //    **
+    0b00111100, //   ****
+    0b01111110, //  ******
+    0b11111111, // ********
+    0b11011011, // ** ** **
+    0b10011001, // *  **  *
+    0b01000010, //  *    *
+    0b00100100  //   *  *
+};
+
+// Flame sprite (4x4)
+static const Uint8 flame_sprite[4] = {
+    0b01100000, //  **
+    0b11110000, // ****
+    0b01100000, //  **
+    0b00100000  //  *
+};
+
+// Ship state, one array per field so each pass over the ships streams
+// through only what it uses (prev_* is the previous tick, for render
+// interpolation). The arrays are `capacity` long, carved from one block
+struct Ships {
+    Cave *cave;
+    int capacity;
+    float *x, *y, *prev_x, *prev_y;
+    float *vel_x, *vel_y;
+    float *fuel;
+    Sint64 *world_x; // Left edge in the cave, as of the last tick
+    float *home_x;   // Column a bot drifts back to
+    Uint8 *dead;
+    Uint8 *main_engine;
+    Uint32 *color;
+    const ShipControls **controls; // NULL for bots
+    AudioVoice *thruster; // Looping thruster voice, 0 when silent
+    int count;
+    int alive;
+    Uint64 ticks;
+
+    // What the frame holds, kept apart from the simulation so a frame can be
+    // drawn while the next is simulated
+    int *drawn_x, *drawn_y; // Where the ship was last drawn
+    const ShipControls **drawn_controls; // Its gauge, if it has one
+    Uint8 *drawn; // Ship (and gauge) are on screen (the cave must be restored under them)
+    int drawn_count;
+};
+
+// Shared by every ship of every cave, and only read once acquired
+static Sound *thruster_sound;
+static Sound *crash_sound;
+static const int GAUGE_Y = 50;
+static const int GAUGE_WIDTH = 20;
+static const int GAUGE_HEIGHT = 100;
+static const int BOT_LOOKAHEAD = 512; // Most columns past the nose a bot plans for
+static const int BOT_MIN_GAP = 24;    // Narrowest gap a bot steers through
+
+// Draw fuel gauge (20x100)
+static void draw_fuel_gauge(Frame *frame, const ShipControls *c, float level) {
+    int gauge_x = c->gauge_x;
+    int gauge_y = GAUGE_Y;
+    int gauge_width = GAUGE_WIDTH;
+    int gauge_height = GAUGE_HEIGHT;
+    int fuel_height = (int)(level * gauge_height / 100.0f);
+
+    // Clear gauge area
+    fill_rect(frame, gauge_x - 1, gauge_y, gauge_width + 2, gauge_height, 0x000000FF);
+
+    // Draw border
+    fill_rect(frame, gauge_x - 1, gauge_y, gauge_width + 2, 1, 0xFFFFFFFF); // Top
+    fill_rect(frame, gauge_x - 1, gauge_y + gauge_height, gauge_width + 2, 1, 0xFFFFFFFF); // Bottom
+    fill_rect(frame, gauge_x - 1, gauge_y, 1, gauge_height, 0xFFFFFFFF); // Left
+    fill_rect(frame, gauge_x + gauge_width, gauge_y, 1, gauge_height, 0xFFFFFFFF); // Right
+
+    // Draw fuel bar (bottom-up)
+    fill_rect(frame, gauge_x, gauge_y + gauge_height - fuel_height, gauge_width, fuel_height, c->gauge_color);
+}
+
+// Point the arrays into the block after the struct, each aligned to 8
+// bytes; with `ships` NULL, only measure the block
+static size_t lay_out(Ships *ships, int capacity) {
+    size_t size = 0;
+#define SHIP_ARRAY(field, type) \
+    size = (size + 7) & ~(size_t)7; \
+    if (ships) ships->field = (type *)((Uint8 *)(ships + 1) + size); \
+    size += capacity * sizeof(type);
+    SHIP_ARRAY(x, float)
+    SHIP_ARRAY(y, float)
+    SHIP_ARRAY(prev_x, float)
+    SHIP_ARRAY(prev_y, float)
+    SHIP_ARRAY(vel_x, float)
+    SHIP_ARRAY(vel_y, float)
+    SHIP_ARRAY(fuel, float)
+    SHIP_ARRAY(world_x, Sint64)
+    SHIP_ARRAY(home_x, float)
+    SHIP_ARRAY(dead, Uint8)
+    SHIP_ARRAY(main_engine, Uint8)
+    SHIP_ARRAY(color, Uint32)
+    SHIP_ARRAY(controls, const ShipControls *)
+    SHIP_ARRAY(thruster, AudioVoice)
+    SHIP_ARRAY(drawn_x, int)
+    SHIP_ARRAY(drawn_y, int)
+    SHIP_ARRAY(drawn_controls, const ShipControls *)
+    SHIP_ARRAY(drawn, Uint8)
+#undef SHIP_ARRAY
+    return size;
+}
+
+Ships *ships_create(Cave *cave, int capacity) {
+    if (capacity < 1 || capacity > MAX_SHIPS) {
+        printf("Ships take 1 to %d at a time\n", MAX_SHIPS);
+        return NULL;
+    }
+    Ships *ships = calloc(1, sizeof(Ships) + lay_out(NULL, capacity));
+    if (!ships) {
+        printf("Out of memory for %d ships\n", capacity);
+        return NULL;
+    }
+    lay_out(ships, capacity);
+    ships->cave = cave;
+    ships->capacity = capacity;
+    return ships;
+}
+
+void ships_destroy(Ships *ships) {
+    if (!ships) return;
+    for (int i = 0; i < ships->count; i++) audio_stop(ships->thruster[i]);
+    free(ships);
+}
+
+void ships_acquire_sounds(void) {
+    if (!thruster_sound) thruster_sound = assets_acquire_sound("thruster.wav");
+    if (!crash_sound) crash_sound = assets_acquire_sound("crash.wav");
+}
+
+void ships_release_sounds(void) {
+    assets_release_sound(thruster_sound);
+    assets_release_sound(crash_sound);
+    thruster_sound = NULL;
+    crash_sound = NULL;
+}
+
+void ships_init(Ships *ships) {
+    for (int i = 0; i < ships->count; i++) audio_stop(ships->thruster[i]); // Thrusters still looping from the last round
+    ships->count = 0;
+    ships->alive = 0;
+    ships->ticks = 0;
+    SDL_memset(ships->drawn, 0, ships->capacity); // The round starts on a freshly drawn cave
+    ships->drawn_count = 0;
+}
+
+static int add_ship(Ships *ships, float start_x, float start_y, Uint32 ship_color, const ShipControls *c) {
+    if (ships->count == ships->capacity) return 0;
+    int i = ships->count++;
+    ships->x[i] = ships->prev_x[i] = ships->home_x[i] = start_x;
+    ships->y[i] = ships->prev_y[i] = start_y;
+    ships->vel_x[i] = 0.0f;
+    ships->vel_y[i] = 0.0f;
+    ships->fuel[i] = 100.0f;
+    ships->world_x[i] = (Sint64)start_x + cave_get_scroll_offset(ships->cave);
+    ships->dead[i] = 0;
+    ships->main_engine[i] = 0;
+    ships->color[i] = ship_color;
+    ships->controls[i] = c;
+    ships->thruster[i] = 0;
+    ships->alive++;
+    return 1;
+}
+
+int ships_add_player(Ships *ships, float start_x, float start_y, Uint32 ship_color, const ShipControls *c) {
+    return add_ship(ships, start_x, start_y, ship_color, c);
+}
+
+int ships_add_bot(Ships *ships, float start_x, Uint32 ship_color) {
+    int top, bottom;
+    Sint64 column = (Sint64)start_x + cave_get_scroll_offset(ships->cave);
+    cave_range(ships->cave, column, column + 7, &top, &bottom);
+    return add_ship(ships, start_x, (top + bottom) / 2 - 4.0f, ship_color, NULL);
+}
+
+// Bot: find the longest stretch ahead (doubling, up to the edge of the
+// screen) with a straight-line gap at least BOT_MIN_GAP high, steer for its
+// middle leading the fall by a second, and drift back to the column it
+// started at. Gravity is slow, so a short look leaves it under a dropping roof
+static void fly_bot(const Ships *ships, int i, Sint64 view_end, int *left, int *right, int *up) {
+    int top, bottom;
+    cave_range(ships->cave, ships->world_x[i], ships->world_x[i] + 7, &top, &bottom);
+    for (int ahead = 16; ahead <= BOT_LOOKAHEAD; ahead *= 2) {
+        Sint64 last = ships->world_x[i] + 7 + ahead;
+        if (last > view_end) break;
+        int t, b;
+        cave_range(ships->cave, ships->world_x[i], last, &t, &b);
+        if (b - t < BOT_MIN_GAP) break;
+        top = t;
+        bottom = b;
+    }
+    float target = (top + bottom) / 2 - 4.0f;
+    *up = ships->y[i] + ships->vel_y[i] * 1.0f > target;
+
+    float drift = (ships->home_x[i] - ships->x[i]) * 0.5f;
+    if (drift > 10.0f) drift = 10.0f;
+    if (drift < -10.0f) drift = -10.0f;
+    *left = ships->vel_x[i] > drift + 1.0f;
+    *right = ships->vel_x[i] < drift - 1.0f;
+}
+
+void ships_update(Ships *ships, float dt, const Uint8 *keys, int sounds) {
+    Sint64 scroll_offset = cave_get_scroll_offset(ships->cave);
+    for (int i = 0; i < ships->count; i++) {
+        ships->prev_x[i] = ships->x[i];
+        ships->prev_y[i] = ships->y[i];
+    }
+    if (ships->alive == 0) return;
+    ships->ticks++;
+
+    // Controls, from the keyboard or the bot
+    for (int i = 0; i < ships->count; i++) {
+        if (ships->dead[i]) continue;
+        const ShipControls *c = ships->controls[i];
+        int left, right, up;
+        if (c) {
+            left = keys[c->left];
+            right = keys[c->right];
+            up = keys[c->thrust];
+        } else {
+            fly_bot(ships, i, scroll_offset + SCREEN_WIDTH - 1, &left, &right, &up);
+        }
+        ships->main_engine[i] = (Uint8)ship_steer(&ships->vel_x[i], &ships->vel_y[i], &ships->fuel[i], left, right, up, dt);
+        int thrusting = left || right || ships->main_engine[i];
+
+        // Sound (players only, hundreds of bot thrusters would drown them out)
+        if (!c || !sounds) continue;
+        if (thrusting && !ships->thruster[i] && ships->fuel[i] > 0 && thruster_sound) {
+            ships->thruster[i] = audio_play(thruster_sound, AUDIO_PRIORITY_NORMAL, 1);
+        } else if (!thrusting && ships->thruster[i]) {
+            audio_stop(ships->thruster[i]);
+            ships->thruster[i] = 0;
+        }
+    }
+
+    // Physics
+    for (int i = 0; i < ships->count; i++) {
+        if (ships->dead[i]) continue;
+        ship_move(&ships->x[i], &ships->y[i], ships->vel_x[i], &ships->vel_y[i], dt);
+    }
+
+    // Collision with cave: the whole hull, along the whole path since the last tick
+    for (int i = 0; i < ships->count; i++) {
+        if (ships->dead[i]) continue;
+        Sint64 prev_world_x = ships->world_x[i];
+        ships->world_x[i] = (Sint64)ships->x[i] + scroll_offset;
+        if (cave_sweep_hits(ships->cave, prev_world_x, (int)ships->prev_y[i], ships->world_x[i], (int)ships->y[i], 8, 8)) {
+            ships->dead[i] = 1;
+            ships->alive--;
+            audio_stop(ships->thruster[i]);
+            ships->thruster[i] = 0;
+            if (!sounds) continue;
+            if (crash_sound) {
+                audio_play(crash_sound, ships->controls[i] ? AUDIO_PRIORITY_HIGH : AUDIO_PRIORITY_LOW, 0);
+            } else if (ships->controls[i]) {
+                printf("Ship %d: Crash sound not loaded!\n", i + 1);
+            }
+            continue;
+        }
+
+        // Fuel pod collision
+        int pods = cave_take_fuel_pods(ships->cave, ships->world_x[i], (int)ships->y[i], 8, 8);
+        if (pods > 0) {
+            ships->fuel[i] += SHIP_FUEL_PER_POD * pods;
+            if (ships->fuel[i] > 100.0f) ships->fuel[i] = 100.0f; // Cap at 100
+        }
+    }
+}
+
+void ships_save(const Ships *ships, ShipState *state) {
+    state->count = ships->count;
+    state->alive = ships->alive;
+    state->ticks = ships->ticks;
+    SDL_memcpy(state->x, ships->x, ships->count * sizeof(float));
+    SDL_memcpy(state->y, ships->y, ships->count * sizeof(float));
+    SDL_memcpy(state->prev_x, ships->prev_x, ships->count * sizeof(float));
+    SDL_memcpy(state->prev_y, ships->prev_y, ships->count * sizeof(float));
+    SDL_memcpy(state->vel_x, ships->vel_x, ships->count * sizeof(float));
+    SDL_memcpy(state->vel_y, ships->vel_y, ships->count * sizeof(float));
+    SDL_memcpy(state->fuel, ships->fuel, ships->count * sizeof(float));
+    SDL_memcpy(state->world_x, ships->world_x, ships->count * sizeof(Sint64));
+    SDL_memcpy(state->dead, ships->dead, ships->count);
+    SDL_memcpy(state->main_engine, ships->main_engine, ships->count);
+}
+
+void ships_load(Ships *ships, const ShipState *state) {
+    ships->count = state->count;
+    ships->alive = state->alive;
+    ships->ticks = state->ticks;
+    SDL_memcpy(ships->x, state->x, ships->count * sizeof(float));
+    SDL_memcpy(ships->y, state->y, ships->count * sizeof(float));
+    SDL_memcpy(ships->prev_x, state->prev_x, ships->count * sizeof(float));
+    SDL_memcpy(ships->prev_y, state->prev_y, ships->count * sizeof(float));
+    SDL_memcpy(ships->vel_x, state->vel_x, ships->count * sizeof(float));
+    SDL_memcpy(ships->vel_y, state->vel_y, ships->count * sizeof(float));
+    SDL_memcpy(ships->fuel, state->fuel, ships->count * sizeof(float));
+    SDL_memcpy(ships->world_x, state->world_x, ships->count * sizeof(Sint64));
+    SDL_memcpy(ships->dead, state->dead, ships->count);
+    SDL_memcpy(ships->main_engine, state->main_engine, ships->count);
+    // A ship that crashed only in the abandoned ticks flies on; its thruster
+    // restarts on the next tick that thrusts
+}
+
+Uint32 ships_hash(const ShipState *state, Uint32 hash) {
+    hash = hash_bytes(hash, &state->count, sizeof(state->count));
+    hash = hash_bytes(hash, &state->alive, sizeof(state->alive));
+    hash = hash_bytes(hash, &state->ticks, sizeof(state->ticks));
+    hash = hash_bytes(hash, state->x, state->count * sizeof(float));
+    hash = hash_bytes(hash, state->y, state->count * sizeof(float));
+    hash = hash_bytes(hash, state->vel_x, state->count * sizeof(float));
+    hash = hash_bytes(hash, state->vel_y, state->count * sizeof(float));
+    hash = hash_bytes(hash, state->fuel, state->count * sizeof(float));
+    hash = hash_bytes(hash, state->dead, state->count);
+    return hash;
+}
+
+void ships_snapshot(const Ships *ships, ShipSnapshot *snap) {
+    snap->count = ships->count;
+    snap->alive = ships->alive;
+    snap->ticks = ships->ticks;
+    SDL_memcpy(snap->x, ships->x, ships->count * sizeof(float));
+    SDL_memcpy(snap->y, ships->y, ships->count * sizeof(float));
+    SDL_memcpy(snap->prev_x, ships->prev_x, ships->count * sizeof(float));
+    SDL_memcpy(snap->prev_y, ships->prev_y, ships->count * sizeof(float));
+    SDL_memcpy(snap->fuel, ships->fuel, ships->count * sizeof(float));
+    SDL_memcpy(snap->dead, ships->dead, ships->count);
+    SDL_memcpy(snap->main_engine, ships->main_engine, ships->count);
+    SDL_memcpy(snap->color, ships->color, ships->count * sizeof(Uint32));
+    SDL_memcpy(snap->controls, ships->controls, ships->count * sizeof(ships->controls[0]));
+}
+
+void ships_erase(Ships *ships, Frame *frame) {
+    for (int i = 0; i < ships->drawn_count; i++) {
+        if (!ships->drawn[i]) continue;
+        cave_restore(ships->cave, frame, ships->drawn_x[i], ships->drawn_y[i], 8, 12); // Ship and flame
+        if (ships->drawn_controls[i]) cave_restore(ships->cave, frame, ships->drawn_controls[i]->gauge_x - 1, GAUGE_Y, GAUGE_WIDTH + 2, GAUGE_HEIGHT + 1);
+        ships->drawn[i] = 0;
+    }
+}
+
+void ships_render(Ships *ships, Frame *frame, const ShipSnapshot *snap, float alpha) {
+    ships->drawn_count = snap->count;
+    for (int i = 0; i < snap->count; i++) {
+        if (snap->dead[i]) continue;
+
+        // Draw at the position blended between the last two ticks
+        ships->drawn_x[i] = (int)timestep_lerp(snap->prev_x[i], snap->x[i], alpha);
+        ships->drawn_y[i] = (int)timestep_lerp(snap->prev_y[i], snap->y[i], alpha);
+        draw_sprite(ships->drawn_x[i], ships->drawn_y[i], ship_sprite, 8, 8, snap->color[i], frame);
+        if (snap->main_engine[i] && (snap->ticks % 16) < 8) {
+            draw_sprite(ships->drawn_x[i] + 2, ships->drawn_y[i] + 8, flame_sprite, 4, 4, 0xFF8000FF, frame); // Flame
+        }
+        ships->drawn_controls[i] = snap->controls[i];
+        ships->drawn[i] = 1;
+    }
+
+    // Gauges last, over any ship flying behind them
+    for (int i = 0; i < snap->count; i++) {
+        if (ships->drawn[i] && snap->controls[i]) draw_fuel_gauge(frame, snap->controls[i], snap->fuel[i]);
+    }
+}
+
+int ships_alive(const Ships *ships) {
+    return ships->alive;
+}
+
+void ships_get(const Ships *ships, int i, ShipInfo *info) {
+    info->x = ships->x[i];
+    info->y = ships->y[i];
+    info->vel_x = ships->vel_x[i];
+    info->vel_y = ships->vel_y[i];
+    info->fuel = ships->fuel[i];
+    info->dead = ships->dead[i];
+}
\ No newline at end of file
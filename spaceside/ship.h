@@ -0,0 +1,118 @@
+#ifndef SHIP_H
+#define SHIP_H
+
+#include <SDL2/SDL.h>
+#include "frame.h"
+#include "cave.h"
+
+// Most ships in a round (players and bots)
+#define MAX_SHIPS 512
+
+// The ships flying through one cave
+typedef struct Ships Ships;
+
+// Keys and fuel gauge of a ship flown from the keyboard
+typedef struct {
+    SDL_Scancode left, right, thrust;
+    int gauge_x;        // Fuel gauge's left edge
+    Uint32 gauge_color; // Fuel bar
+} ShipControls;
+
+// What drawing a frame needs from the simulation, copied out after its
+// ticks so the next frame can be simulated while this one is drawn
+typedef struct {
+    int count, alive;
+    Uint64 ticks;
+    float x[MAX_SHIPS], y[MAX_SHIPS], prev_x[MAX_SHIPS], prev_y[MAX_SHIPS];
+    float fuel[MAX_SHIPS];
+    Uint8 dead[MAX_SHIPS];
+    Uint8 main_engine[MAX_SHIPS];
+    Uint32 color[MAX_SHIPS];
+    const ShipControls *controls[MAX_SHIPS];
+} ShipSnapshot;
+
+// Everything a tick changes in the ships, for rolling back
+typedef struct {
+    int count, alive;
+    Uint64 ticks;
+    float x[MAX_SHIPS], y[MAX_SHIPS], prev_x[MAX_SHIPS], prev_y[MAX_SHIPS];
+    float vel_x[MAX_SHIPS], vel_y[MAX_SHIPS];
+    float fuel[MAX_SHIPS];
+    Sint64 world_x[MAX_SHIPS];
+    Uint8 dead[MAX_SHIPS];
+    Uint8 main_engine[MAX_SHIPS];
+} ShipState;
+
+// One ship as of the last tick
+typedef struct {
+    float x, y, vel_x, vel_y; // Screen position and px/s
+    float fuel;               // Percent
+    int dead;
+} ShipInfo;
+
+// Flight model (px/s^2, and percent of a tank per second)
+#define SHIP_GRAVITY 6.0f
+#define SHIP_THRUST 12.0f
+#define SHIP_FUEL_BURN 1.2f
+#define SHIP_FUEL_PER_POD 5.0f // Percent
+
+// One tick of a ship's flight, on one entry of struct-of-arrays state
+// (shared by ships_update and the headless env). Steering: side jets and
+// the main engine, which needs fuel; returns 1 if the main engine fired
+static inline int ship_steer(float *vel_x, float *vel_y, float *fuel, int left, int right, int up, float dt) {
+    if (left) *vel_x -= SHIP_THRUST * dt;
+    if (right) *vel_x += SHIP_THRUST * dt;
+    if (!up || *fuel <= 0) return 0;
+    *vel_y -= SHIP_THRUST * dt;
+    *fuel -= SHIP_FUEL_BURN * dt;
+    return 1;
+}
+// Then falling and moving, kept on screen
+static inline void ship_move(float *x, float *y, float vel_x, float *vel_y, float dt) {
+    *vel_y += SHIP_GRAVITY * dt;
+    *x += vel_x * dt;
+    *y += *vel_y * dt;
+    if (*x < 0) *x = 0;
+    if (*x + 8 > SCREEN_WIDTH) *x = SCREEN_WIDTH - 8;
+}
+
+// Make room for up to `capacity` ships (at most MAX_SHIPS) flying through
+// `cave`. Returns NULL on failure
+Ships *ships_create(Cave *cave, int capacity);
+void ships_destroy(Ships *ships);
+// Acquire the sounds every ship plays (after assets_open) and release them
+// (after audio_shutdown). Without them ships fly silently
+void ships_acquire_sounds(void);
+void ships_release_sounds(void);
+// Remove every ship (call after cave_init so bots can find the gap, and
+// never while a frame is being drawn)
+void ships_init(Ships *ships);
+// Add a ship at screen (x, y); returns 0 when the round is full.
+// `controls` must outlive the round
+int ships_add_player(Ships *ships, float x, float y, Uint32 color, const ShipControls *controls);
+// Add a ship flown by a bot that follows the middle of the gap, starting
+// there at screen x
+int ships_add_bot(Ships *ships, float x, Uint32 color);
+
+// Advance every ship one tick of `dt` seconds against the cave as of the
+// same tick, with players' keys held in `keys` (indexed by scancode).
+// Without `sounds` the tick is silent, for ticks that are run again
+void ships_update(Ships *ships, float dt, const Uint8 *keys, int sounds);
+// Save and load the state of the last tick (the ships themselves must not
+// have changed in between)
+void ships_save(const Ships *ships, ShipState *state);
+void ships_load(Ships *ships, const ShipState *state);
+// Fold a saved state into `hash` (hash.h)
+Uint32 ships_hash(const ShipState *state, Uint32 hash);
+// Copy out the ships as of the last tick
+void ships_snapshot(const Ships *ships, ShipSnapshot *snap);
+// Put the cave back where ships and gauges were drawn (before the cave scrolls)
+void ships_erase(Ships *ships, Frame *frame);
+// Draw a snapshot blended `alpha` of the way from its previous tick to its current one
+void ships_render(Ships *ships, Frame *frame, const ShipSnapshot *snap, float alpha);
+// Ships still flying
+int ships_alive(const Ships *ships);
+// Look at ship `i`
+void ships_get(const Ships *ships, int i, ShipInfo *info);
+
+#endif // SHIP_H
\ No newline at end of file